@@ -3,10 +3,91 @@
 #include <string>
 #include <limits> // Para std::numeric_limits (o DBL_MAX)
 #include <iomanip> // Para std::setprecision
+#include <algorithm> // Para std::max
+#include <cmath> // Para std::abs
+#include <random> // Para as instâncias da verificação
+#include <chrono> // Para comparar Knuth com a versão cúbica
+#include <cstdint> // Para int32_t
+#include <map> // Para comparar a árvore materializada com std::map
+#include <atomic> // Para o índice adaptativo (contadores e ponteiro publicado)
+#include <thread> // Para a reconstrução em segundo plano
+#include <array> // Para a árvore em tempo de compilação
+#include "interval_table.h" // TriangularTable: tabelas [i, j] compactas, por diagonal
+#include "diagonal_sweep.h" // parallelDiagonals: diagonais divididas entre threads
+#include <cstring> // Para std::memcmp (tabelas idênticas bit a bit)
+#include <charconv> // Para std::to_chars no exportador
+#include <sstream> // Para exportar para memória nos testes
+#include "perf_counter.h" // Faltas de cache na comparação de layouts
+
+/**
+ * @brief Versão cúbica original do OPTIMAL-BST (Cormen, 15.5): testa toda raiz r em [i, j].
+ * Mantida como referência para verifyOptimalBST. Parâmetros iguais aos de optimalBST.
+ */
+void optimalBSTCubic(const std::vector<double>& p,
+                     const std::vector<double>& q,
+                     int n,
+                     std::vector<std::vector<double>>& e,
+                     std::vector<std::vector<double>>& w,
+                     std::vector<std::vector<int>>& root) {
+
+    e.resize(n + 2, std::vector<double>(n + 2));
+    w.resize(n + 2, std::vector<double>(n + 2));
+    root.resize(n + 2, std::vector<int>(n + 2));
+
+    for (int i = 1; i <= n + 1; ++i) {
+        e[i][i - 1] = q[i - 1];
+        w[i][i - 1] = q[i - 1];
+    }
+
+    for (int l = 1; l <= n; ++l) {
+        for (int i = 1; i <= n - l + 1; ++i) {
+            int j = i + l - 1;
+            e[i][j] = std::numeric_limits<double>::max();
+            w[i][j] = w[i][j - 1] + p[j] + q[j];
+            for (int r = i; r <= j; ++r) {
+                double cost = e[i][r - 1] + e[r + 1][j] + w[i][j];
+                if (cost < e[i][j]) {
+                    e[i][j] = cost;
+                    root[i][j] = r;
+                }
+            }
+        }
+    }
+}
 
 /**
  * @brief Preenche as tabelas de DP para o problema da Árvore de Busca Binária Ótima.
- * (Baseado no algoritmo OPTIMAL-BST do Cormen, 15.5)
+ * (Baseado no algoritmo OPTIMAL-BST do Cormen, 15.5, com a otimização de Knuth)
+ *
+ * Knuth mostrou que as raízes ótimas são monótonas:
+ * root[i][j-1] <= root[i][j] <= root[i+1][j].
+ * Então, em vez de testar r em todo [i, j], basta testar esse intervalo.
+ * Somando sobre uma diagonal, os intervalos se encaixam e custam O(n) no
+ * total, o que leva o algoritmo de O(n^3) para O(n^2).
+ * Como a primeira raiz de custo mínimo está sempre dentro do intervalo, as
+ * raízes e os custos saem iguais, bit a bit, aos da versão cúbica (veja
+ * verifyOptimalBST).
+ *
+ * As tabelas podem ser TriangularTable (interval_table.h), o formato usado
+ * no programa: só o triângulo [i, j] com j >= i - 1, guardado por diagonal,
+ * então cada comprimento l é varrido em sequência na memória. Também valem
+ * as tabelas aninhadas (n+2) x (n+2) originais, mantidas para comparação.
+ *
+ * Não há tabela w: como as diagonais são varridas em ordem crescente de l,
+ * basta um vetor w_diag[i] = w(i, i+l-1), atualizado no lugar com a mesma
+ * soma do livro, w(i, j) = w(i, j-1) + p[j] + q[j]. São O(n) de memória e
+ * os mesmos bits da tabela w, então os empates (k2 e k4 no exemplo do
+ * livro) se resolvem como lá, com comparação estrita. (Somas de prefixo
+ * arredondariam w de outro jeito e virariam esses empates.)
+ *
+ * Com e e root compactas, a memória fica em (n+1)(n+2)/2 * (8 + 4) bytes:
+ * cerca de 15 GB para n = 50000, contra 50 GB das três tabelas aninhadas do
+ * livro. "Poucos GB" só vale até n = 20000 (2.4 GB); para n = 50000 a
+ * tabela e, de 8 bytes por intervalo, sozinha já passa de 10 GB.
+ *
+ * As células de um mesmo comprimento l são independentes. Com threads != 1,
+ * cada diagonal é dividida entre as threads por parallelDiagonals
+ * (diagonal_sweep.h), e as tabelas saem idênticas às da versão serial.
  *
  * @param p Vetor de probabilidades das chaves REAIS (1-indexado, p[1..n]).
  * p[i] é a probabilidade de buscar a chave k_i.
@@ -16,40 +97,45 @@
  * @param n O número de chaves reais.
  * @param e Tabela de custo (passada por referência). e[i][j] guardará
  * o custo esperado mínimo da árvore para as chaves k_i ... k_j.
- * @param w Tabela de pesos (passada por referência). w[i][j] guardará
- * a soma das probabilidades de p[i..j] e q[i-1..j].
  * @param root Tabela de raízes (passada por referência). root[i][j] guardará
  * o índice 'r' da raiz k_r que otimiza a árvore [i..j].
+ * @param threads Número de threads (1 = serial, 0 = hardware_concurrency).
  */
+template <typename CostTable, typename RootTable>
 void optimalBST(const std::vector<double>& p,
                 const std::vector<double>& q,
                 int n,
-                std::vector<std::vector<double>>& e,
-                std::vector<std::vector<double>>& w,
-                std::vector<std::vector<int>>& root) {
+                CostTable& e,
+                RootTable& root,
+                int threads = 1) {
 
     // --- 1. Redimensionar as tabelas ---
-    // 'e' e 'w' precisam de índices [1..n+1][0..n]
+    // 'e' precisa de índices [1..n+1][0..n]
     // 'root' precisa de índices [1..n][1..n]
-    // Para simplificar, alocamos um pouco a mais (n+2 x n+2)
-    e.resize(n + 2, std::vector<double>(n + 2));
-    w.resize(n + 2, std::vector<double>(n + 2));
-    root.resize(n + 2, std::vector<int>(n + 2));
+    resizeIntervalTable(e, n);
+    resizeIntervalTable(root, n);
+
+    // Pesos da diagonal corrente: w_diag[i] = w(i, i+l-1). Começa em l = 0,
+    // w(i, i-1) = q[i-1]. Cada célula só mexe no próprio w_diag[i], então as
+    // threads de uma diagonal não disputam posições.
+    std::vector<double> w_diag(n + 2);
+    for (int i = 1; i <= n + 1; ++i) w_diag[i] = q[i - 1];
 
     // --- 2. Casos Base (Comprimento l=0, ou j = i-1) ---
     // Uma árvore para o intervalo k_i..k_{i-1} só contém
     // a chave fictícia d_{i-1}. O custo é q[i-1].
     for (int i = 1; i <= n + 1; ++i) {
         e[i][i - 1] = q[i - 1];
-        w[i][i - 1] = q[i - 1];
     }
 
     // --- 3. Construção da Tabela (Bottom-Up) ---
-    // 'l' é o comprimento da cadeia de chaves (de 1 até n)
-    for (int l = 1; l <= n; ++l) {
+    // 'l' é o comprimento da cadeia de chaves (de 1 até n).
+    // solveCells resolve as células de comprimento l com i em [i_begin, i_end);
+    // parallelDiagonals chama em ordem crescente de l, dividindo cada diagonal.
+    auto solveCells = [&](int l, int i_begin, int i_end) {
         
         // 'i' é a chave inicial da sub-árvore (de 1 até n-l+1)
-        for (int i = 1; i <= n - l + 1; ++i) {
+        for (int i = i_begin; i < i_end; ++i) {
             
             // 'j' é a chave final da sub-árvore
             int j = i + l - 1;
@@ -57,34 +143,1131 @@ void optimalBST(const std::vector<double>& p,
             // Inicializa o custo como "infinito"
             e[i][j] = std::numeric_limits<double>::max();
             
-            // Calcula w[i][j] usando a fórmula de DP
-            // w(i, j) = w(i, j-1) + p[j] + q[j]
-            w[i][j] = w[i][j - 1] + p[j] + q[j];
+            // w(i, j) = w(i, j-1) + p[j] + q[j], na mesma ordem do livro
+            double w_ij = w_diag[i] + p[j] + q[j];
+            w_diag[i] = w_ij;
 
-            // --- Encontra a raiz 'r' ótima (de i até j) ---
+            // --- Encontra a raiz 'r' ótima ---
             // Este é o passo central da recorrência:
             // e[i,j] = min_{i<=r<=j} { e[i,r-1] + e[r+1,j] + w(i,j) }
-            for (int r = i; r <= j; ++r) {
+            // mas só entre root[i][j-1] e root[i+1][j] (Knuth).
+            // Para l = 1 o único candidato é r = i.
+            int r_lo = (l == 1) ? i : root[i][j - 1];
+            int r_hi = (l == 1) ? i : root[i + 1][j];
+            for (int r = r_lo; r <= r_hi; ++r) {
                 
                 // Custo se 'r' for a raiz:
                 // (custo da sub-árvore esquerda) + (custo da sub-árvore direita) + (soma das probs)
-                double cost = e[i][r - 1] + e[r + 1][j] + w[i][j];
+                double cost = e[i][r - 1] + e[r + 1][j] + w_ij;
 
                 // Se este 'r' dá um custo menor, atualiza
+                // (empates ficam com a menor raiz, como no livro)
                 if (cost < e[i][j]) {
                     e[i][j] = cost;
                     root[i][j] = r; // Armazena 'r' como a melhor raiz para [i,j]
                 }
             }
         }
+    };
+    // Com os limites de Knuth, cada célula testa poucas raízes em média.
+    parallelDiagonals(n, 1, threads, [](int) { return 4; }, solveCells);
+}
+
+/**
+ * @brief Modo de verificação: roda a versão de Knuth (tabelas compactas) e a cúbica e compara as tabelas.
+ *
+ * @param root_mismatches Recebe quantas células root[i][j] diferem.
+ * @return double A maior diferença |e_knuth[i][j] - e_cubico[i][j]| encontrada.
+ */
+double verifyOptimalBST(const std::vector<double>& p,
+                        const std::vector<double>& q,
+                        int n, int& root_mismatches) {
+    TriangularTable<double> e1;
+    TriangularTable<int> root1;
+    std::vector<std::vector<double>> e2, w2;
+    std::vector<std::vector<int>> root2;
+    optimalBST(p, q, n, e1, root1);
+    optimalBSTCubic(p, q, n, e2, w2, root2);
+
+    double max_diff = 0.0;
+    root_mismatches = 0;
+    for (int i = 1; i <= n + 1; ++i) {
+        for (int j = i - 1; j <= n; ++j) {
+            max_diff = std::max(max_diff, std::abs(e1[i][j] - e2[i][j]));
+            if (j >= i && root1[i][j] != root2[i][j]) root_mismatches++;
+        }
+    }
+    return max_diff;
+}
+
+/**
+ * @brief Estado da árvore ótima incremental: pesos atuais e tabelas completas.
+ */
+struct OBSTState {
+    int n;
+    std::vector<double> p, q;     // Pesos atuais (mesmo formato do optimalBST)
+    TriangularTable<double> e;
+    TriangularTable<int> root;
+    long long recomputed_cells;   // Na última atualização
+};
+
+/**
+ * @brief Monta o estado inicial (um optimalBST completo).
+ */
+OBSTState obstBuild(const std::vector<double>& p, const std::vector<double>& q, int n) {
+    OBSTState state = {n, p, q, {}, {}, 0};
+    optimalBST(p, q, n, state.e, state.root);
+    state.recomputed_cells = (long long)n * (n + 1) / 2;
+    return state;
+}
+
+/**
+ * @brief Aplica várias mudanças de peso e recalcula só os intervalos afetados.
+ *
+ * Cada peso tem uma posição na fila q_0 p_1 q_1 ... p_n q_n: 2r - 1 é a
+ * chave k_r e 2g é a fictícia d_g. O intervalo [i, j] cobre as posições
+ * 2(i-1) a 2j, e e[i][j] só depende dos pesos que ele cobre. Então só os
+ * intervalos que cobrem alguma posição alterada mudam. Para cada
+ * comprimento l eles formam faixas de i, uma por posição, que se juntam
+ * numa passada porque as posições estão ordenadas.
+ *
+ * As faixas são recalculadas em ordem crescente de l, com a mesma conta do
+ * optimalBST. Os limites de Knuth root[i][j-1] e root[i+1][j] vêm da tabela
+ * de raízes: são os antigos, para intervalos não afetados, ou os já
+ * recalculados. O vetor w_diag do optimalBST avança em todas as posições a
+ * cada l (O(n) somas por comprimento, sem a busca de raízes), então as
+ * tabelas saem idênticas, bit a bit, às de um optimalBST completo com os
+ * pesos novos.
+ *
+ * Com uma mudança na posição c, são cerca de (c/2) * (n - c/2) intervalos:
+ * no máximo n^2/4 (chave do meio) em vez de n^2/2, e bem menos perto das
+ * pontas. Um lote de mudanças é aplicado numa passada só.
+ *
+ * @param state Estado incremental (atualizado no lugar).
+ * @param updates Pares (posição na fila, novo peso).
+ * @return double O novo custo e[1][n].
+ */
+double obstUpdate(OBSTState& state, const std::vector<std::pair<int, double>>& updates) {
+    int n = state.n;
+    state.recomputed_cells = 0;
+
+    // --- Passo 1: Aplica os pesos e ordena as posições alteradas ---
+    std::vector<int> changed;
+    for (const auto& [slot, value] : updates) {
+        double& weight = (slot % 2 == 0) ? state.q[slot / 2] : state.p[(slot + 1) / 2];
+        if (weight == value) continue;
+        weight = value;
+        changed.push_back(slot);
+    }
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+    if (changed.empty()) return state.e[1][n];
+
+    // Pesos por diagonal, como no optimalBST.
+    const std::vector<double>& p = state.p;
+    const std::vector<double>& q = state.q;
+    std::vector<double> w_diag(n + 2);
+    for (int i = 1; i <= n + 1; ++i) w_diag[i] = q[i - 1];
+
+    // --- Passo 2: Casos base (l = 0) das fictícias alteradas ---
+    for (int slot : changed) {
+        if (slot % 2 == 0) state.e[slot / 2 + 1][slot / 2] = q[slot / 2];
+    }
+
+    // --- Passo 3: Faixas de i afetadas, por comprimento ---
+    TriangularTable<double>& e = state.e;
+    TriangularTable<int>& root = state.root;
+    for (int l = 1; l <= n; ++l) {
+        int last = n - l + 1;
+        for (int i = 1; i <= last; ++i) w_diag[i] = w_diag[i] + p[i + l - 1] + q[i + l - 1];
+        int run_lo = 0, run_hi = -1; // Faixa corrente, ainda não resolvida
+        auto solveRun = [&](int lo, int hi) {
+            for (int i = lo; i <= hi; ++i) {
+                int j = i + l - 1;
+                double w_ij = w_diag[i];
+                double best = std::numeric_limits<double>::max();
+                int r_lo = (l == 1) ? i : root[i][j - 1];
+                int r_hi = (l == 1) ? i : root[i + 1][j];
+                for (int r = r_lo; r <= r_hi; ++r) {
+                    double cost = e[i][r - 1] + e[r + 1][j] + w_ij;
+                    if (cost < best) {
+                        best = cost;
+                        root[i][j] = r;
+                    }
+                }
+                e[i][j] = best;
+            }
+            state.recomputed_cells += hi - lo + 1;
+        };
+        for (int slot : changed) {
+            // [i, i+l-1] cobre a posição 'slot' se 2i - 2 <= slot <= 2i + 2l - 2.
+            int from = slot - 2 * l + 2;
+            int lo = std::max(1, from <= 0 ? 1 : (from + 1) / 2);
+            int hi = std::min(last, slot / 2 + 1);
+            if (lo > hi) continue;
+            if (lo <= run_hi + 1) {
+                run_hi = std::max(run_hi, hi);
+            } else {
+                if (run_hi >= run_lo) solveRun(run_lo, run_hi);
+                run_lo = lo;
+                run_hi = hi;
+            }
+        }
+        if (run_hi >= run_lo) solveRun(run_lo, run_hi);
+    }
+    return e[1][n];
+}
+
+/**
+ * @brief Muda o peso de uma única chave k_r (caso comum).
+ */
+double obstUpdateKey(OBSTState& state, int r, double value) {
+    return obstUpdate(state, {{2 * r - 1, value}});
+}
+
+/**
+ * @brief Tabela de raízes esparsa, só com os intervalos [i, j] que aparecem na árvore.
+ *
+ * Uma árvore com n chaves tem exatamente n intervalos, então guardamos
+ * (j, r) agrupados por i (formato CSR): O(n) de memória em vez de O(n^2).
+ * root[i][j] funciona como na tabela densa, para os intervalos da árvore.
+ */
+struct IntervalRoots {
+    std::vector<int> row_start; // Entradas de i em [row_start[i], row_start[i+1])
+    std::vector<int> end;       // j de cada entrada (crescente dentro de cada i)
+    std::vector<int> key;       // r de cada entrada
+
+    struct Row {
+        const IntervalRoots& table;
+        int i;
+        int operator[](int j) const {
+            auto first = table.end.begin() + table.row_start[i];
+            auto last = table.end.begin() + table.row_start[i + 1];
+            auto it = std::lower_bound(first, last, j);
+            return (it != last && *it == j) ? table.key[it - table.end.begin()] : 0;
+        }
+    };
+    Row operator[](int i) const { return Row{*this, i}; }
+
+    /**
+     * Monta a tabela a partir de uma lista de intervalos [first[t], last[t]]
+     * com raiz key[t], em qualquer ordem (contagem por i, depois ordena cada linha por j).
+     */
+    void assign(int n, const std::vector<int>& first,
+                const std::vector<int>& last, const std::vector<int>& roots) {
+        int entries = first.size();
+        row_start.assign(n + 2, 0);
+        for (int t = 0; t < entries; ++t) row_start[first[t] + 1]++;
+        for (int i = 1; i <= n + 1; ++i) row_start[i] += row_start[i - 1];
+        std::vector<std::pair<int, int>> slots(entries);
+        std::vector<int> fill(row_start.begin(), row_start.end() - 1);
+        for (int t = 0; t < entries; ++t) {
+            slots[fill[first[t]]++] = {last[t], roots[t]};
+        }
+        end.resize(entries);
+        key.resize(entries);
+        for (int i = 0; i <= n; ++i) {
+            std::sort(slots.begin() + row_start[i], slots.begin() + row_start[i + 1]);
+        }
+        for (int t = 0; t < entries; ++t) {
+            end[t] = slots[t].first;
+            key[t] = slots[t].second;
+        }
+    }
+};
+
+/**
+ * @brief Sequência de pesos com inserção/remoção por posição em O(log n) (treap implícita).
+ *
+ * Usada pelo Garsia-Wachs, que precisa achar, à esquerda de uma posição, o
+ * primeiro peso >= s e inserir a soma ali; num vetor isso custa O(n) por passo.
+ * Cada nó guarda o máximo da subárvore para essa busca. Os índices dos nós
+ * são os ids dos nós da árvore (folhas e internos).
+ */
+struct WeightSequence {
+    struct Node {
+        double weight, max_weight;
+        int lc, rc, size;
+        unsigned priority;
+    };
+    std::vector<Node> node; // 32 bytes por nó: cada nível da descida toca uma linha de cache
+    int root = -1;
+    unsigned seed = 2463534242u;
+
+    explicit WeightSequence(int capacity) : node(capacity) {}
+
+    int count() const { return root < 0 ? 0 : node[root].size; }
+    int sz(int t) const { return t < 0 ? 0 : node[t].size; }
+
+    void pull(int t) {
+        Node& x = node[t];
+        x.size = 1 + sz(x.lc) + sz(x.rc);
+        x.max_weight = x.weight;
+        if (x.lc >= 0) x.max_weight = std::max(x.max_weight, node[x.lc].max_weight);
+        if (x.rc >= 0) x.max_weight = std::max(x.max_weight, node[x.rc].max_weight);
+    }
+
+    int merge(int a, int b) {
+        if (a < 0) return b;
+        if (b < 0) return a;
+        if (node[a].priority > node[b].priority) {
+            node[a].rc = merge(node[a].rc, b);
+            pull(a);
+            return a;
+        }
+        node[b].lc = merge(a, node[b].lc);
+        pull(b);
+        return b;
+    }
+
+    // a = primeiros k elementos de t, b = o resto.
+    void split(int t, int k, int& a, int& b) {
+        if (t < 0) { a = b = -1; return; }
+        int left_size = sz(node[t].lc);
+        if (left_size < k) {
+            split(node[t].rc, k - left_size - 1, node[t].rc, b);
+            pull(t);
+            a = t;
+        } else {
+            split(node[t].lc, k, a, node[t].lc);
+            pull(t);
+            b = t;
+        }
+    }
+
+    // Prepara o nó 'id' isolado, com prioridade aleatória (xorshift).
+    void makeNode(int id, double w) {
+        seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+        node[id] = {w, w, -1, -1, 1, seed};
+    }
+
+    void append(int id, double w) {
+        makeNode(id, w);
+        root = merge(root, id);
+    }
+
+    // Peso do elemento na posição dada.
+    double weightAt(int position) const {
+        int t = root;
+        while (true) {
+            int left_size = sz(node[t].lc);
+            if (position < left_size) {
+                t = node[t].lc;
+            } else if (position == left_size) {
+                return node[t].weight;
+            } else {
+                position -= left_size + 1;
+                t = node[t].rc;
+            }
+        }
+    }
+
+    /**
+     * Passo do Garsia-Wachs: tira os elementos das posições k-1 e k (ids em
+     * 'a' e 'b'), cria o nó 'id' com a soma dos pesos e o insere logo à
+     * direita do último peso >= soma antes da posição k-1.
+     * Devolve a posição onde o nó novo ficou.
+     */
+    int combine(int k, int id, int& a, int& b) {
+        int prefix, pair, rest;
+        split(root, k - 1, prefix, pair);
+        split(pair, 2, pair, rest);
+        a = node[pair].lc >= 0 ? node[pair].lc : pair;
+        b = node[pair].rc >= 0 ? node[pair].rc : pair;
+        double sum = node[a].weight + node[b].weight;
+
+        // Última posição do prefixo com peso >= soma (a sentinela garante que existe).
+        int t = prefix, found = 0, offset = 0;
+        while (true) {
+            const Node& x = node[t];
+            if (x.rc >= 0 && node[x.rc].max_weight >= sum) {
+                offset += sz(x.lc) + 1;
+                t = x.rc;
+            } else if (x.weight >= sum) {
+                found = offset + sz(x.lc);
+                break;
+            } else {
+                t = x.lc;
+            }
+        }
+
+        makeNode(id, sum);
+        int before, after;
+        split(prefix, found + 1, before, after);
+        root = merge(merge(before, id), merge(after, rest));
+        return found + 1;
+    }
+};
+
+/**
+ * @brief Árvore alfabética ótima (Garsia-Wachs) para o caso p = 0.
+ *
+ * Quando só as chaves fictícias têm probabilidade, o custo é
+ * e[1][n] = sum_i q_i (profundidade(d_i) + 1), e o Garsia-Wachs resolve sem a DP:
+ * 1. Combinação: na sequência de pesos, acha o primeiro k com
+ *    q_{k-1} <= q_{k+1}, junta q_{k-1} e q_k, e reinsere a soma logo à
+ *    direita do primeiro peso >= soma à esquerda. A árvore resultante não é
+ *    alfabética, mas as profundidades das folhas são as de uma ótima.
+ * 2. Reconstrução: com essas profundidades, uma pilha monta a árvore
+ *    alfabética (duas folhas/subárvores vizinhas de mesmo nível viram irmãs).
+ *
+ * A sequência fica numa treap implícita (WeightSequence) com sentinela +inf
+ * à esquerda, então cada busca/reinserção custa O(log n): O(n log n) de
+ * tempo esperado e O(n) de memória.
+ *
+ * @param q Probabilidades das chaves fictícias (q[0..n]).
+ * @param n Número de chaves reais.
+ * @param root Recebe as raízes de cada intervalo da árvore.
+ * @return double O custo esperado e[1][n] (o mesmo de optimalBST com p = 0).
+ */
+double garsiaWachs(const std::vector<double>& q, int n, IntervalRoots& root) {
+
+    // --- Passo 1: Combinação (nós 0..n são folhas, n+1..2n internos) ---
+    // A sequência de pesos vive numa treap implícita; o nó 2n+1 é a sentinela +inf.
+    std::vector<int> left(2 * n + 1, -1), right(2 * n + 1, -1);
+    int next_node = n + 1;
+    WeightSequence seq(2 * n + 2);
+    seq.append(2 * n + 1, std::numeric_limits<double>::infinity());
+
+    // Junta as posições k-1 e k e reinsere a soma logo à direita do primeiro
+    // peso >= soma à esquerda. Devolve a posição onde a soma ficou.
+    auto combine = [&](int k) {
+        int id = next_node++;
+        return seq.combine(k, id, left[id], right[id]);
+    };
+    auto w = [&](int position) { return seq.weightAt(position); };
+    // Depois de uma combinação, a soma na posição j pode criar um novo par
+    // q_{j-2} <= q_j. Cada nova combinação é resolvida antes de voltar à
+    // anterior (pilha de posições, contadas a partir do fim da sequência).
+    std::vector<int> pending;
+    auto cascade = [&](int j) {
+        pending.push_back(seq.count() - j);
+        while (!pending.empty()) {
+            int position = seq.count() - pending.back();
+            if (position >= 2 && w(position) >= w(position - 2)) {
+                int inserted = combine(position - 1);
+                pending.push_back(seq.count() - inserted);
+            } else {
+                pending.pop_back();
+            }
+        }
+    };
+
+    for (int i = 0; i <= n; ++i) {
+        seq.append(i, q[i]);
+        while (seq.count() >= 4 && w(seq.count() - 3) <= w(seq.count() - 1)) {
+            cascade(combine(seq.count() - 2));
+        }
+    }
+    // O que sobra tem q_{k-1} > q_{k+1}; a sentinela da direita (+inf) faz juntar o fim.
+    while (seq.count() > 2) {
+        cascade(combine(seq.count() - 1));
+    }
+
+    // --- Passo 2: Profundidade das folhas (pais foram criados depois dos filhos) ---
+    std::vector<int> depth(2 * n + 1, 0);
+    for (int id = 2 * n; id > n; --id) {
+        depth[left[id]] = depth[right[id]] = depth[id] + 1;
+    }
+    double cost = 0.0;
+    for (int i = 0; i <= n; ++i) {
+        cost += q[i] * (depth[i] + 1);
+    }
+
+    // --- Passo 3: Árvore alfabética com as mesmas profundidades ---
+    // Cada item da pilha é uma subárvore pronta: (nível, primeira folha, última folha).
+    // Juntar duas vizinhas de folhas a..b e b+1..c cria o nó da chave k_{b+1},
+    // que cobre as chaves a+1..c.
+    struct Subtree { int level, first, last; };
+    std::vector<Subtree> stack;
+    std::vector<int> entry_i(n), end(n), key(n);
+    int entries = 0;
+    for (int i = 0; i <= n; ++i) {
+        stack.push_back({depth[i], i, i});
+        while (stack.size() >= 2 && stack[stack.size() - 2].level == stack.back().level) {
+            Subtree b = stack.back();
+            stack.pop_back();
+            Subtree& a = stack.back();
+            entry_i[entries] = a.first + 1;
+            end[entries] = b.last;
+            key[entries] = a.last + 1;
+            entries++;
+            a = {a.level - 1, a.first, b.last};
+        }
+    }
+
+    // --- Passo 4: Agrupa por i (CSR) ---
+    entry_i.resize(entries);
+    end.resize(entries);
+    key.resize(entries);
+    root.assign(n, entry_i, end, key);
+    return cost;
+}
+
+/**
+ * @brief Árvore quase ótima por bissecção de pesos (Mehlhorn), em O(n) de memória.
+ *
+ * Com as chaves e as fictícias enfileiradas (q_0 p_1 q_1 ... p_n q_n), seja
+ * s_i a posição do meio da fictícia d_i:
+ * s_i = q_0 + p_1 + q_1 + ... + p_i + q_i / 2.
+ * Para as chaves i..j, a raiz é a chave k_r que contém o ponto médio
+ * (s_{i-1} + s_j) / 2, isto é, s_{r-1} <= meio <= s_r. Ela é achada por busca
+ * exponencial a partir das duas pontas, o que custa O(log min(r - i, j - r)).
+ * No total são O(n) passos, e a pilha de intervalos é explícita.
+ *
+ * Garantia (Mehlhorn): o comprimento ponderado de caminho P da árvore
+ * satisfaz P <= H + 2, onde H é a entropia de (p, q). Como e = P + sum q_i,
+ * o custo fica em e <= H + 2 + sum q_i. Já o ótimo nunca fica abaixo de
+ * H / log2(3) + sum q_i.
+ *
+ * @param p Probabilidades das chaves (p[1..n]).
+ * @param q Probabilidades das fictícias (q[0..n]).
+ * @param n Número de chaves.
+ * @param root Recebe as raízes de cada intervalo (mesmo formato do garsiaWachs).
+ * @return double O custo esperado da árvore (comparável a e[1][n]).
+ */
+double mehlhornBST(const std::vector<double>& p, const std::vector<double>& q,
+                   int n, IntervalRoots& root) {
+
+    // --- Passo 1: Pontos médios das fictícias ---
+    std::vector<double> s(n + 1);
+    double prefix = 0.0;
+    for (int i = 0; i <= n; ++i) {
+        if (i > 0) prefix += p[i];
+        s[i] = prefix + q[i] / 2;
+        prefix += q[i];
+    }
+
+    // --- Passo 2: Bissecção com pilha explícita ---
+    // Cada item é um intervalo de chaves i..j e a profundidade da sua raiz.
+    struct Range { int i, j, depth; };
+    std::vector<Range> stack = {{1, n, 0}};
+    std::vector<int> first, last, roots;
+    first.reserve(n);
+    last.reserve(n);
+    roots.reserve(n);
+    double cost = 0.0;
+
+    while (!stack.empty()) {
+        Range range = stack.back();
+        stack.pop_back();
+        int i = range.i, j = range.j;
+        if (i > j) {
+            // Sub-árvore vazia: só a fictícia d_j, uma comparação a mais.
+            cost += q[j] * (range.depth + 1);
+            continue;
+        }
+
+        // Menor r em [i, j] com s_r >= meio; as buscas andam 1, 2, 4, ... das duas pontas.
+        double middle = (s[i - 1] + s[j]) / 2;
+        int lo = i, hi = j;
+        for (int step = 1; lo < hi; step *= 2) {
+            int a = i + step - 1;
+            if (a >= hi) break;
+            if (s[a] >= middle) { hi = a; break; }
+            lo = a + 1;
+            int b = j - step;
+            if (b < lo) break;
+            if (s[b] < middle) { lo = b + 1; break; }
+            hi = b;
+        }
+        int r = std::lower_bound(s.begin() + lo, s.begin() + hi, middle) - s.begin();
+
+        first.push_back(i);
+        last.push_back(j);
+        roots.push_back(r);
+        cost += p[r] * (range.depth + 1);
+        stack.push_back({r + 1, j, range.depth + 1});
+        stack.push_back({i, r - 1, range.depth + 1});
+    }
+
+    root.assign(n, first, last, roots);
+    return cost;
+}
+
+/**
+ * @brief Entropia (em bits) da distribuição (p, q), usada nos limites do mehlhornBST.
+ */
+double accessEntropy(const std::vector<double>& p, const std::vector<double>& q, int n) {
+    double h = 0.0;
+    for (int i = 1; i <= n; ++i) if (p[i] > 0) h -= p[i] * std::log2(p[i]);
+    for (int i = 0; i <= n; ++i) if (q[i] > 0) h -= q[i] * std::log2(q[i]);
+    return h;
+}
+
+/**
+ * @brief Nó da árvore de consulta: chave inline e filhos como índices de 32 bits.
+ *
+ * child[0] / child[1] >= 0 é o índice de outro nó no mesmo vetor; um valor
+ * negativo -(g + 1) indica a fictícia d_g (busca sem sucesso no intervalo g).
+ */
+struct LookupNode {
+    long long key;
+    int32_t child[2];
+};
+
+/**
+ * @brief Ordem dos nós no vetor.
+ */
+enum TreeLayout {
+    LAYOUT_DFS,         // Pré-ordem, esquerda antes da direita
+    LAYOUT_HEAVY_FIRST  // Pré-ordem, filho de maior probabilidade logo após o pai
+};
+
+/**
+ * @brief Árvore de busca materializada num vetor plano, pronta para consultas.
+ */
+struct LookupTree {
+    std::vector<LookupNode> nodes; // nodes[0] é a raiz
+    std::vector<int> rank;         // rank[t] = índice r da chave k_r guardada no nó t
+
+    /**
+     * Busca 'x'. Devolve r (1..n) se x == k_r, ou -(g + 1) se x cai na fictícia d_g.
+     * O laço só tem o desvio de parada; o lado da descida é um índice
+     * (child[x > key]), não um if.
+     */
+    int lookup(long long x) const {
+        int t = 0;
+        while (true) {
+            const LookupNode& node = nodes[t];
+            if (node.key == x) return rank[t];
+            t = node.child[x > node.key];
+            if (t < 0) return t;
+        }
+    }
+};
+
+/**
+ * @brief Transforma a tabela de raízes num LookupTree.
+ *
+ * Percorre a árvore em pré-ordem com uma pilha explícita. No layout
+ * LAYOUT_HEAVY_FIRST o filho de maior peso (soma de p e q do intervalo) vem
+ * logo depois do pai, então o caminho mais provável é quase sequencial na memória.
+ *
+ * @param root Tabela de raízes (densa ou IntervalRoots).
+ * @param key_values key_values[r] = valor da chave k_r (crescente, 1-indexado).
+ * @param p, q Probabilidades (usadas só pelo layout LAYOUT_HEAVY_FIRST).
+ * @param n Número de chaves (n >= 1).
+ */
+template <typename RootTable>
+LookupTree buildLookupTree(const RootTable& root, const std::vector<long long>& key_values,
+                           const std::vector<double>& p, const std::vector<double>& q,
+                           int n, TreeLayout layout) {
+    // Pesos dos intervalos por somas de prefixo: weight(i, j) = W[j] - W[i-1] + q[i-1].
+    std::vector<double> W(n + 1);
+    W[0] = q[0];
+    for (int i = 1; i <= n; ++i) W[i] = W[i - 1] + p[i] + q[i];
+    auto weight = [&](int i, int j) { return W[j] - W[i - 1] + q[i - 1]; };
+
+    LookupTree tree;
+    tree.nodes.reserve(n);
+    tree.rank.reserve(n);
+
+    // Cada item: intervalo de chaves i..j e onde gravar o índice do nó criado.
+    struct Item { int i, j, parent, side; };
+    std::vector<Item> stack = {{1, n, -1, 0}};
+    while (!stack.empty()) {
+        Item item = stack.back();
+        stack.pop_back();
+
+        int link;
+        if (item.i > item.j) {
+            link = -(item.j + 1); // Fictícia d_j
+        } else {
+            int r = root[item.i][item.j];
+            link = tree.nodes.size();
+            tree.nodes.push_back({key_values[r], {0, 0}});
+            tree.rank.push_back(r);
+
+            Item left = {item.i, r - 1, link, 0};
+            Item right = {r + 1, item.j, link, 1};
+            bool right_first = layout == LAYOUT_HEAVY_FIRST &&
+                               weight(r + 1, item.j) > weight(item.i, r - 1);
+            // O último empilhado é o próximo a receber índice.
+            if (right_first) {
+                stack.push_back(left);
+                stack.push_back(right);
+            } else {
+                stack.push_back(right);
+                stack.push_back(left);
+            }
+        }
+        if (item.parent >= 0) tree.nodes[item.parent].child[item.side] = link;
+    }
+    return tree;
+}
+
+/**
+ * @brief Compara LookupTree (dois layouts), std::map e busca binária num vetor ordenado.
+ *
+ * As consultas seguem a própria distribuição (p, q): a chave k_r vale 2r e a
+ * fictícia d_g é consultada com o valor 2g + 1. Imprime ns por consulta.
+ */
+void benchmarkLookups(const LookupTree& dfs, const LookupTree& heavy,
+                      const std::vector<double>& p, const std::vector<double>& q,
+                      int n, int count, std::mt19937& rng) {
+    // --- Consultas sorteadas pela distribuição acumulada ---
+    std::vector<double> cumulative(2 * n + 1);
+    double total = 0.0;
+    for (int t = 0; t <= 2 * n; ++t) {
+        total += (t % 2 == 0) ? q[t / 2] : p[(t + 1) / 2];
+        cumulative[t] = total;
+    }
+    std::uniform_real_distribution<double> uniform(0.0, total);
+    std::vector<long long> queries(count);
+    for (long long& x : queries) {
+        int t = std::lower_bound(cumulative.begin(), cumulative.end(), uniform(rng)) - cumulative.begin();
+        x = std::min(t, 2 * n); // t par: fictícia d_{t/2} (2g + 1 = t + 1); ímpar: chave (2r = t + 1)
+        x += 1;
+    }
+
+    std::vector<long long> sorted(n);
+    std::map<long long, int> ordered;
+    for (int r = 1; r <= n; ++r) {
+        sorted[r - 1] = 2LL * r;
+        ordered[2LL * r] = r;
+    }
+
+    // Cada estrutura devolve r na busca com sucesso e um valor <= 0 na sem sucesso.
+    auto timeIt = [&](const char* label, auto&& find) {
+        long long checksum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (long long x : queries) {
+            int r = find(x);
+            checksum += r > 0 ? r : 0;
+        }
+        auto stop = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(stop - start).count() / count;
+        std::cout << "\t" << label << ": " << ns << " ns/consulta (checksum " << checksum << ")" << std::endl;
+    };
+    timeIt("arvore plana, DFS       ", [&](long long x) { return dfs.lookup(x); });
+    timeIt("arvore plana, mais prov.", [&](long long x) { return heavy.lookup(x); });
+    timeIt("std::map                ", [&](long long x) {
+        auto it = ordered.find(x);
+        return it == ordered.end() ? 0 : it->second;
+    });
+    timeIt("vetor ordenado          ", [&](long long x) {
+        auto it = std::lower_bound(sorted.begin(), sorted.end(), x);
+        return (it != sorted.end() && *it == x) ? (int)(it - sorted.begin()) + 1 : 0;
+    });
+}
+
+/**
+ * @brief Contadores de acesso divididos em fatias (shards), sem trava.
+ *
+ * Cada leitor soma só na sua fatia com fetch_add relaxado, então leitores
+ * diferentes não disputam a mesma cache line. As posições seguem a fila
+ * q_0 p_1 q_1 ... p_n q_n: a posição 2g é a fictícia d_g e 2r - 1 é a chave k_r.
+ */
+struct AccessCounters {
+    int slots;  // 2n + 1
+    int stride; // slots arredondado para múltiplo de 8 (64 bytes por fatia)
+    int shards;
+    std::vector<std::atomic<uint64_t>> count; // count[s * stride + t]
+
+    AccessCounters(int n, int shards)
+        : slots(2 * n + 1), stride((2 * n + 1 + 7) / 8 * 8), shards(shards),
+          count((size_t)shards * stride) {}
+
+    /**
+     * Registra o resultado de uma busca (r > 0: chave k_r; -(g + 1): fictícia d_g).
+     */
+    void record(int shard, int result) {
+        int t = result > 0 ? 2 * result - 1 : 2 * (-result - 1);
+        count[(size_t)shard * stride + t].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Soma as fatias. Os leitores continuam contando durante a soma, então o
+     * retrato é aproximado, o que basta para estimar a distribuição.
+     */
+    void snapshot(std::vector<uint64_t>& totals) const {
+        totals.assign(slots, 0);
+        for (int s = 0; s < shards; ++s) {
+            for (int t = 0; t < slots; ++t) {
+                totals[t] += count[(size_t)s * stride + t].load(std::memory_order_relaxed);
+            }
+        }
+    }
+};
+
+/**
+ * @brief Nós visitados por uma busca a cada posição da fila (2r - 1: chave k_r, 2g: fictícia d_g).
+ *
+ * Os nós do LookupTree estão em pré-ordem, então o pai sempre vem antes dos
+ * filhos e uma passada só basta.
+ */
+std::vector<int> slotVisits(const LookupTree& tree, int n) {
+    std::vector<int> visits(2 * n + 1), depth(tree.nodes.size());
+    depth[0] = 1;
+    for (size_t t = 0; t < tree.nodes.size(); ++t) {
+        visits[2 * tree.rank[t] - 1] = depth[t];
+        for (int side = 0; side < 2; ++side) {
+            int child = tree.nodes[t].child[side];
+            if (child >= 0) depth[child] = depth[t] + 1;
+            else visits[2 * (-child - 1)] = depth[t]; // A busca sem sucesso para no pai
+        }
+    }
+    return visits;
+}
+
+/**
+ * @brief Nós visitados por busca, em média, sob a distribuição (p, q).
+ */
+double expectedVisits(const std::vector<int>& visits, const std::vector<double>& p,
+                      const std::vector<double>& q, int n) {
+    double cost = q[0] * visits[0];
+    for (int r = 1; r <= n; ++r) cost += p[r] * visits[2 * r - 1] + q[r] * visits[2 * r];
+    return cost;
+}
+
+/**
+ * @brief Uma verificação da thread de reconstrução (para o relatório).
+ */
+struct RebuildEvent {
+    double time_ms;      // Desde a criação do índice
+    uint64_t samples;    // Buscas na janela
+    double cost_current; // Nós por busca da árvore publicada, sob a janela
+    double cost_probe;   // Nós por busca da sonda (Mehlhorn), sob a janela
+    bool rebuilt;
+};
+
+/**
+ * @brief Índice que aprende p e q com o próprio tráfego e se reconstrói em segundo plano.
+ *
+ * Leitura (qualquer número de threads, nunca bloqueia): a árvore publicada é
+ * um ponteiro atômico. O leitor anuncia a época global no seu slot, lê o
+ * ponteiro, busca, zera o slot e conta o resultado nos AccessCounters.
+ *
+ * Reconstrução (uma thread): a cada período, a janela de contagens desde a
+ * última verificação vira uma distribuição (com meia contagem em cada
+ * posição, para nenhuma chave ficar com peso zero). Uma sonda barata, a
+ * bissecção de Mehlhorn em O(n), diz quanto uma árvore nova ganharia sobre a
+ * atual nessa janela. Só se o ganho relativo passar do limiar ('drift') a
+ * árvore definitiva é construída (optimalBST até exact_limit chaves; acima
+ * disso, a própria sonda) e publicada.
+ *
+ * Publicação no estilo RCU: troca o ponteiro, avança a época e espera cada
+ * slot ficar livre ou numa época nova. Daí nenhum leitor pode estar com a
+ * árvore antiga, e ela é apagada. Só a thread de reconstrução espera.
+ */
+struct AdaptiveIndex {
+    struct alignas(64) ReaderSlot {
+        std::atomic<uint64_t> epoch{0}; // 0 = fora de uma busca
+    };
+
+    int n;
+    int exact_limit;
+    std::vector<long long> key_values;
+    AccessCounters counters;
+    std::vector<ReaderSlot> readers;
+    std::atomic<const LookupTree*> current{nullptr};
+    std::atomic<uint64_t> epoch{1};
+
+    // Estado da thread de reconstrução.
+    std::vector<int> current_visits;
+    std::vector<uint64_t> window_start;
+    std::chrono::steady_clock::time_point created;
+    std::vector<RebuildEvent> log;
+
+    /**
+     * Começa com a árvore dos pesos uniformes (balanceada).
+     * @param reader_count Número de threads leitoras (cada uma usa um id em [0, reader_count)).
+     */
+    AdaptiveIndex(const std::vector<long long>& key_values, int n, int reader_count, int exact_limit)
+        : n(n), exact_limit(exact_limit), key_values(key_values),
+          counters(n, reader_count), readers(reader_count),
+          window_start(2 * n + 1, 0), created(std::chrono::steady_clock::now()) {
+        std::vector<double> p(n + 1, 1.0 / (2 * n + 1)), q(n + 1, 1.0 / (2 * n + 1));
+        p[0] = 0.0;
+        LookupTree* tree = new LookupTree(build(p, q));
+        current_visits = slotVisits(*tree, n);
+        current.store(tree);
+    }
+
+    ~AdaptiveIndex() { delete current.load(); }
+
+    /**
+     * Busca x na árvore publicada (mesmo retorno de LookupTree::lookup).
+     */
+    int lookup(int reader, long long x) {
+        ReaderSlot& slot = readers[reader];
+        slot.epoch.store(epoch.load());
+        int result = current.load()->lookup(x);
+        slot.epoch.store(0, std::memory_order_release);
+        counters.record(reader, result);
+        return result;
+    }
+
+    /**
+     * Árvore definitiva para (p, q): exata até exact_limit chaves, Mehlhorn acima.
+     */
+    LookupTree build(const std::vector<double>& p, const std::vector<double>& q) const {
+        if (n <= exact_limit) {
+            TriangularTable<double> e;
+            TriangularTable<int> root;
+            optimalBST(p, q, n, e, root);
+            return buildLookupTree(root, key_values, p, q, n, LAYOUT_HEAVY_FIRST);
+        }
+        IntervalRoots root;
+        mehlhornBST(p, q, n, root);
+        return buildLookupTree(root, key_values, p, q, n, LAYOUT_HEAVY_FIRST);
+    }
+
+    /**
+     * Troca a árvore publicada e apaga a antiga depois que os leitores saírem dela.
+     */
+    void publish(const LookupTree* fresh) {
+        const LookupTree* old = current.exchange(fresh);
+        uint64_t now = epoch.fetch_add(1) + 1;
+        for (ReaderSlot& slot : readers) {
+            while (true) {
+                uint64_t seen = slot.epoch.load();
+                if (seen == 0 || seen >= now) break;
+                std::this_thread::yield();
+            }
+        }
+        delete old;
+    }
+
+    /**
+     * Uma verificação: mede o ganho na janela atual e reconstrói se passar de 'drift'.
+     * @param min_samples Janelas menores continuam acumulando até a próxima verificação.
+     * @return bool Se uma árvore nova foi publicada.
+     */
+    bool checkAndRebuild(double drift, uint64_t min_samples) {
+        // --- Passo 1: Distribuição da janela ---
+        std::vector<uint64_t> totals;
+        counters.snapshot(totals);
+        uint64_t samples = 0;
+        for (int t = 0; t <= 2 * n; ++t) samples += totals[t] - window_start[t];
+        if (samples < min_samples) return false;
+
+        std::vector<double> p(n + 1, 0.0), q(n + 1);
+        double denominator = samples + 0.5 * (2 * n + 1);
+        for (int t = 0; t <= 2 * n; ++t) {
+            double weight = (totals[t] - window_start[t] + 0.5) / denominator;
+            if (t % 2 == 0) q[t / 2] = weight;
+            else p[(t + 1) / 2] = weight;
+        }
+        window_start = totals;
+
+        // --- Passo 2: Sonda barata (Mehlhorn) ---
+        IntervalRoots probe_root;
+        mehlhornBST(p, q, n, probe_root);
+        LookupTree probe = buildLookupTree(probe_root, key_values, p, q, n, LAYOUT_HEAVY_FIRST);
+        double cost_current = expectedVisits(current_visits, p, q, n);
+        double cost_probe = expectedVisits(slotVisits(probe, n), p, q, n);
+        bool rebuild = cost_current - cost_probe > drift * cost_current;
+        double time_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - created).count();
+        log.push_back({time_ms, samples, cost_current, cost_probe, rebuild});
+        if (!rebuild) return false;
+
+        // --- Passo 3: Árvore definitiva e publicação ---
+        LookupTree* fresh = new LookupTree(n <= exact_limit ? build(p, q) : std::move(probe));
+        current_visits = slotVisits(*fresh, n);
+        publish(fresh);
+        return true;
+    }
+
+    /**
+     * Laço da thread de reconstrução: verifica a cada 'period' até 'stop'.
+     */
+    void rebuildLoop(const std::atomic<bool>& stop, std::chrono::milliseconds period,
+                     double drift, uint64_t min_samples) {
+        while (!stop.load()) {
+            std::this_thread::sleep_for(period);
+            checkAndRebuild(drift, min_samples);
+        }
+    }
+};
+
+/**
+ * @brief Tabela de raízes calculada em tempo de compilação (N chaves, fixo).
+ */
+template <int N>
+struct StaticRoots {
+    int root[N + 2][N + 2] = {};
+    double cost = 0.0; // e[1][N]
+};
+
+/**
+ * @brief optimalBST em constexpr, para conjuntos de chaves fixos (opcodes, palavras-chave).
+ *
+ * Mesma recorrência, pesos por diagonal e limites de Knuth do optimalBST, mas com
+ * arrays de tamanho fixo, então o compilador resolve tudo na compilação.
+ * Pensado para N pequeno (dezenas de chaves): o limite de passos do
+ * constexpr do compilador cresce como N^2.
+ */
+template <int N>
+constexpr StaticRoots<N> staticOptimalBST(const std::array<double, N + 1>& p,
+                                          const std::array<double, N + 1>& q) {
+    StaticRoots<N> result;
+    double e[N + 2][N + 2] = {};
+    double w_diag[N + 2] = {};
+    for (int i = 1; i <= N + 1; ++i) e[i][i - 1] = w_diag[i] = q[i - 1];
+    for (int l = 1; l <= N; ++l) {
+        for (int i = 1; i <= N - l + 1; ++i) {
+            int j = i + l - 1;
+            double w_ij = w_diag[i] + p[j] + q[j];
+            w_diag[i] = w_ij;
+            e[i][j] = std::numeric_limits<double>::max();
+            int r_lo = (l == 1) ? i : result.root[i][j - 1];
+            int r_hi = (l == 1) ? i : result.root[i + 1][j];
+            for (int r = r_lo; r <= r_hi; ++r) {
+                double cost = e[i][r - 1] + e[r + 1][j] + w_ij;
+                if (cost < e[i][j]) {
+                    e[i][j] = cost;
+                    result.root[i][j] = r;
+                }
+            }
+        }
     }
+    result.cost = e[1][N];
+    return result;
 }
 
 /**
- * @brief Imprime a estrutura da Árvore Ótima recursivamente.
+ * @brief Árvore de decisão desenrolada por templates, sem tabela em tempo de execução.
+ *
+ * Cada instância cuida do intervalo de chaves I..J: a raiz r sai da tabela
+ * constexpr, e a chave Keys[r] vira uma constante imediata na comparação.
+ * Depois do inline sobra só uma cadeia de if/else, a mesma que
+ * emitDecisionTree escreve como código-fonte.
+ * Retorno igual ao de LookupTree::lookup: r, ou -(g + 1) para a fictícia d_g.
+ */
+template <const auto& Keys, const auto& Roots, int I, int J>
+struct StaticDecision {
+    static constexpr int lookup(long long x) {
+        if constexpr (I > J) {
+            return -(J + 1);
+        } else {
+            constexpr int r = Roots.root[I][J];
+            if (x == Keys[r]) return r;
+            if (x < Keys[r]) return StaticDecision<Keys, Roots, I, r - 1>::lookup(x);
+            return StaticDecision<Keys, Roots, r + 1, J>::lookup(x);
+        }
+    }
+};
+
+/**
+ * @brief Modo gerador: escreve a árvore ótima como uma função C++ com if/else aninhados.
+ *
+ * Serve quando as probabilidades vêm de um arquivo de medições: roda-se o
+ * optimalBST uma vez, no build, e o código gerado entra no programa. Usa
+ * uma pilha explícita, então árvores degeneradas profundas não estouram a
+ * pilha de chamadas.
+ *
+ * @param root Tabela de raízes (densa ou IntervalRoots).
+ * @param key_values key_values[r] = valor da chave k_r (crescente, 1-indexado).
+ * @param name Nome da função gerada: int name(long long x).
+ */
+template <typename RootTable>
+void emitDecisionTree(std::ostream& out, const RootTable& root,
+                      const std::vector<long long>& key_values, int n, const std::string& name) {
+    // Cada intervalo vira um bloco; a sub-árvore direita vem depois do 'if' da
+    // esquerda, que sempre retorna, então não precisa de 'else'.
+    // Sem recursão, como em printOptimalStructure: cada item da pilha é um
+    // intervalo a escrever ou (i > j e close) o '}' que fecha um bloco.
+    struct Item { int i, j, indent; bool close; };
+    std::vector<Item> stack = {{1, n, 1, false}};
+    out << "int " << name << "(long long x) {" << '\n';
+    while (!stack.empty()) {
+        Item item = stack.back();
+        stack.pop_back();
+        std::string pad(item.indent * 4, ' ');
+        if (item.close) {
+            out << pad << "}" << '\n';
+            continue;
+        }
+        if (item.i > item.j) {
+            out << pad << "return " << -(item.j + 1) << ";" << '\n';
+            continue;
+        }
+        int r = root[item.i][item.j];
+        out << pad << "if (x == " << key_values[r] << ") return " << r << ";" << '\n';
+        out << pad << "if (x < " << key_values[r] << ") {" << '\n';
+        // Ordem de saída: esquerda (um nível para dentro), '}', direita.
+        stack.push_back({r + 1, item.j, item.indent, false});
+        stack.push_back({0, 0, item.indent, true});
+        stack.push_back({item.i, r - 1, item.indent + 1, false});
+    }
+    out << "}" << std::endl;
+}
+
+/**
+ * @brief Hash perfeito multiplicativo para um conjunto fixo de chaves: h(x) = (x * a) >> shift.
+ *
+ * Sorteia multiplicadores ímpares até nenhuma chave colidir numa tabela de
+ * 2^b posições, dobrando a tabela se demorar. Só responde se achou (r) ou
+ * não (0); não diz em qual intervalo a chave ausente cai.
+ */
+struct PerfectHash {
+    uint64_t multiplier = 1;
+    int shift = 63;
+    std::vector<long long> table_key;
+    std::vector<int> table_rank;
+
+    void build(const std::vector<long long>& key_values, int n, std::mt19937& rng) {
+        int bits = 1;
+        while ((1 << bits) < 2 * n) bits++;
+        std::uniform_int_distribution<uint64_t> pick;
+        for (int attempt = 0; ; ++attempt) {
+            if (attempt > 0 && attempt % 1000 == 0) bits++;
+            multiplier = pick(rng) | 1;
+            shift = 64 - bits;
+            table_key.assign(1 << bits, std::numeric_limits<long long>::min());
+            table_rank.assign(1 << bits, 0);
+            bool collision = false;
+            for (int r = 1; r <= n && !collision; ++r) {
+                size_t h = ((uint64_t)key_values[r] * multiplier) >> shift;
+                collision = table_rank[h] != 0;
+                table_key[h] = key_values[r];
+                table_rank[h] = r;
+            }
+            if (!collision) return;
+        }
+    }
+
+    int lookup(long long x) const {
+        size_t h = ((uint64_t)x * multiplier) >> shift;
+        return table_key[h] == x ? table_rank[h] : 0;
+    }
+};
+
+// Exemplo do livro em constexpr: a raiz k2 e o custo 2.75 saem na compilação.
+constexpr std::array<double, 6> BOOK_P = {0.0, 0.15, 0.10, 0.05, 0.10, 0.20};
+constexpr std::array<double, 6> BOOK_Q = {0.05, 0.10, 0.05, 0.05, 0.05, 0.10};
+constexpr StaticRoots<5> BOOK_ROOTS = staticOptimalBST<5>(BOOK_P, BOOK_Q);
+static_assert(BOOK_ROOTS.root[1][5] == 2, "raiz do exemplo do livro deve ser k2");
+static_assert(BOOK_ROOTS.cost > 2.7499 && BOOK_ROOTS.cost < 2.7501, "custo do exemplo do livro deve ser 2.75");
+
+// Tabela fixa de exemplo: códigos de status HTTP, com frequências de um log típico.
+// q_g é a chance de um código desconhecido entre HTTP_CODES[g] e HTTP_CODES[g+1]
+// (zero quando não há inteiro entre os dois).
+constexpr int HTTP_KEYS = 27;
+constexpr std::array<long long, HTTP_KEYS + 1> HTTP_CODES = {
+    0, 100, 101, 200, 201, 202, 204, 206, 301, 302, 303, 304, 307, 308,
+    400, 401, 403, 404, 405, 408, 409, 410, 429, 500, 501, 502, 503, 504};
+constexpr std::array<double, HTTP_KEYS + 1> HTTP_P = {
+    0.0, 0.001, 0.002, 0.619, 0.03, 0.01, 0.03, 0.005, 0.02, 0.05, 0.002, 0.08, 0.003, 0.001,
+    0.01, 0.02, 0.01, 0.05, 0.002, 0.002, 0.003, 0.001, 0.01, 0.01, 0.001, 0.005, 0.008, 0.003};
+constexpr std::array<double, HTTP_KEYS + 1> HTTP_Q = {
+    0.001, 0.0, 0.001, 0.0, 0.0, 0.001, 0.001, 0.001, 0.0, 0.0, 0.0, 0.001, 0.0, 0.001,
+    0.0, 0.001, 0.0, 0.0, 0.001, 0.0, 0.0, 0.001, 0.001, 0.0, 0.0, 0.0, 0.0, 0.001};
+constexpr StaticRoots<HTTP_KEYS> HTTP_ROOTS = staticOptimalBST<HTTP_KEYS>(HTTP_P, HTTP_Q);
+
+/**
+ * @brief Imprime a estrutura da Árvore Ótima, sem recursão.
  * (Baseado no procedimento CONSTRUCT-OPTIMAL-BST do Cormen)
  *
- * @param root A tabela de raízes preenchida.
+ * A ordem é a mesma da versão recursiva do livro (pré-ordem: raiz, esquerda,
+ * direita), com uma pilha explícita de intervalos no lugar das chamadas.
+ * Árvores degeneradas com milhões de nós não estouram a pilha. As linhas
+ * terminam com '\n' e o cout só é descarregado no fim.
+ *
+ * @param root A tabela de raízes preenchida (densa, ou IntervalRoots).
  * @param keys Nomes das chaves reais (k1, k2, ...)
  * @param dummies Nomes das chaves fictícias (d0, d1, ...)
  * @param i Início do intervalo da sub-árvore.
@@ -92,43 +1275,165 @@ void optimalBST(const std::vector<double>& p,
  * @param parent_r A raiz da árvore-pai (para fins de impressão).
  * @param is_left_child Flag para saber se esta é uma sub-árvore esquerda.
  */
-void printOptimalStructure(const std::vector<std::vector<int>>& root,
+template <typename RootTable>
+void printOptimalStructure(const RootTable& root,
                            const std::vector<std::string>& keys,
                            const std::vector<std::string>& dummies,
                            int i, int j, int parent_r, bool is_left_child) {
-    
-    // --- Caso Base: Sub-árvore vazia (contém uma chave fictícia) ---
-    if (i > j) {
-        // Se i = j+1, a sub-árvore contém a chave fictícia d_j
-        if (j == i - 1) {
-            std::string side = is_left_child ? "filho esquerdo" : "filho direito";
-            std::cout << "\t" << dummies[j] << " e o " << side << " de " << keys[parent_r] << std::endl;
+
+    // Cada item é uma chamada pendente da versão recursiva.
+    struct Call { int i, j, parent_r; bool is_left_child; };
+    std::vector<Call> stack = {{i, j, parent_r, is_left_child}};
+
+    while (!stack.empty()) {
+        Call call = stack.back();
+        stack.pop_back();
+        const char* side = call.is_left_child ? "filho esquerdo" : "filho direito";
+
+        // --- Caso Base: Sub-árvore vazia (contém uma chave fictícia) ---
+        if (call.i > call.j) {
+            // Se i = j+1, a sub-árvore contém a chave fictícia d_j
+            if (call.j == call.i - 1) {
+                std::cout << "\t" << dummies[call.j] << " e o " << side << " de " << keys[call.parent_r] << '\n';
+            }
+            continue;
         }
-        return;
+
+        // 1. Encontra a raiz 'r' para este intervalo [i, j]
+        int r = root[call.i][call.j]; // r é o índice da chave (ex: 2 para k2)
+
+        // 2. Imprime a raiz atual
+        if (call.parent_r == 0) {
+            std::cout << keys[r] << " e a raiz da arvore." << '\n';
+        } else {
+            std::cout << keys[r] << " e o " << side << " de " << keys[call.parent_r] << '\n';
+        }
+
+        // 3. Empilha a direita [r+1, j] e depois a esquerda [i, r-1],
+        // para a esquerda sair primeiro
+        stack.push_back({r + 1, call.j, r, false});
+        stack.push_back({call.i, r - 1, r, true});
     }
+    std::cout << std::flush;
+}
 
-    // --- Passo Recursivo ---
-    // 1. Encontra a raiz 'r' para este intervalo [i, j]
-    int r = root[i][j]; // r é o índice da chave (ex: 2 para k2)
+/**
+ * @brief Escrita com buffer próprio: junta a saída em blocos de 64 KB antes de ir para o stream.
+ */
+struct BufferedWriter {
+    std::ostream& out;
+    std::string buffer;
+
+    explicit BufferedWriter(std::ostream& out) : out(out) { buffer.reserve(1 << 16); }
+    ~BufferedWriter() { flush(); }
 
-    // 2. Imprime a raiz atual
-    if (parent_r == 0) {
-        std::cout << keys[r] << " e a raiz da arvore." << std::endl;
-    } else {
-        std::string side = is_left_child ? "filho esquerdo" : "filho direito";
-        std::cout << keys[r] << " e o " << side << " de " << keys[parent_r] << std::endl;
+    void flush() {
+        out.write(buffer.data(), buffer.size());
+        buffer.clear();
+    }
+    void put(const char* text) {
+        buffer += text;
+        if (buffer.size() >= (1 << 16)) flush();
     }
+    void put(long long value) {
+        char digits[24];
+        char* end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+        buffer.append(digits, end);
+        if (buffer.size() >= (1 << 16)) flush();
+    }
+    void putRaw(const void* data, size_t bytes) {
+        buffer.append((const char*)data, bytes);
+        if (buffer.size() >= (1 << 16)) flush();
+    }
+};
+
+/**
+ * @brief Formatos de exportação da árvore.
+ */
+enum ExportFormat {
+    EXPORT_DOT,   // Graphviz: uma aresta por linha
+    EXPORT_JSON,  // {"n", "root", "nodes": [{"key", "left", "right"}, ...]} em pré-ordem
+    EXPORT_BINARY // "OBST", n, raiz e (left, right) de cada chave, tudo int32
+};
 
-    // 3. Chama recursivamente para a sub-árvore esquerda [i, r-1]
-    printOptimalStructure(root, keys, dummies, i, r - 1, r, true);
+/**
+ * @brief Exporta a árvore da tabela de raízes, sem recursão e com BufferedWriter.
+ *
+ * Os filhos seguem a convenção do LookupNode: r > 0 é a chave k_r e -(g + 1)
+ * é a fictícia d_g. No binário, o registro da chave k_r (r = 1..n) fica na
+ * posição r - 1, então quem lê acessa um nó direto pelo índice.
+ *
+ * @param root Tabela de raízes (densa ou IntervalRoots).
+ * @param n Número de chaves (n >= 1).
+ */
+template <typename RootTable>
+void exportTree(std::ostream& out, const RootTable& root, int n, ExportFormat format) {
+    BufferedWriter writer(out);
+    std::vector<int32_t> children; // Só no binário: children[2(r-1)] e [2(r-1)+1]
+    if (format == EXPORT_BINARY) children.assign(2 * (size_t)n, 0);
 
-    // 4. Chama recursivamente para a sub-árvore direita [r+1, j]
-    printOptimalStructure(root, keys, dummies, r + 1, j, r, false);
+    if (format == EXPORT_DOT) writer.put("digraph OBST {\n    node [shape=circle];\n");
+    if (format == EXPORT_JSON) {
+        writer.put("{\"n\": ");
+        writer.put((long long)n);
+        writer.put(", \"root\": ");
+        writer.put((long long)root[1][n]);
+        writer.put(", \"nodes\": [");
+    }
+
+    // Pré-ordem com pilha de intervalos.
+    struct Range { int i, j; };
+    std::vector<Range> stack = {{1, n}};
+    bool first = true;
+    while (!stack.empty()) {
+        Range range = stack.back();
+        stack.pop_back();
+        int r = root[range.i][range.j];
+        int left = (range.i <= r - 1) ? root[range.i][r - 1] : -r;             // Fictícia d_{r-1}
+        int right = (r + 1 <= range.j) ? root[r + 1][range.j] : -(range.j + 1); // Fictícia d_j
+
+        if (format == EXPORT_DOT) {
+            for (int child : {left, right}) {
+                writer.put("    k");
+                writer.put((long long)r);
+                writer.put(child > 0 ? " -> k" : " -> d");
+                writer.put((long long)(child > 0 ? child : -child - 1));
+                writer.put(";\n");
+            }
+        } else if (format == EXPORT_JSON) {
+            writer.put(first ? "\n  {\"key\": " : ",\n  {\"key\": ");
+            writer.put((long long)r);
+            writer.put(", \"left\": ");
+            writer.put((long long)left);
+            writer.put(", \"right\": ");
+            writer.put((long long)right);
+            writer.put("}");
+        } else {
+            children[2 * (size_t)(r - 1)] = left;
+            children[2 * (size_t)(r - 1) + 1] = right;
+        }
+        first = false;
+
+        if (r + 1 <= range.j) stack.push_back({r + 1, range.j});
+        if (range.i <= r - 1) stack.push_back({range.i, r - 1});
+    }
+
+    if (format == EXPORT_DOT) writer.put("}\n");
+    if (format == EXPORT_JSON) writer.put("\n]}\n");
+    if (format == EXPORT_BINARY) {
+        int32_t header[2] = {n, root[1][n]};
+        writer.putRaw("OBST", 4);
+        writer.putRaw(header, sizeof(header));
+        writer.putRaw(children.data(), children.size() * sizeof(int32_t));
+    }
 }
 
 
 // Main para teste
-int main() {
+int main(int argc, char* argv[]) {
+    // Com "--bench", também roda a DP exata em n = 20000.
+    bool bench = argc > 1 && std::string(argv[1]) == "--bench";
+
     std::cout << "---" << std::endl;
     std::cout << "Algoritmo: Arvores de Busca Binaria Otimas (OBST)" << std::endl;
     std::cout << "Secao 15.5 do Cormen (3a ed.)" << std::endl;
@@ -157,12 +1462,11 @@ int main() {
     std::cout << "------------------------------------------" << std::endl;
 
     // Tabelas de DP
-    std::vector<std::vector<double>> e; // Custo esperado
-    std::vector<std::vector<double>> w; // Pesos (soma das probs)
-    std::vector<std::vector<int>> root; // Raiz ótima
+    TriangularTable<double> e; // Custo esperado
+    TriangularTable<int> root; // Raiz ótima
 
     // 1. Executa o algoritmo
-    optimalBST(p, q, n, e, w, root);
+    optimalBST(p, q, n, e, root);
 
     // 2. Imprime o resultado final (Custo da árvore completa e[1][n])
     std::cout << std::fixed << std::setprecision(2); // Formata para 2 casas decimais
@@ -192,6 +1496,528 @@ int main() {
     //                 d3 e o filho direito de k3
     //             d4 e o filho direito de k4
     //         d5 e o filho direito de k5
+
+    // --- Teste: Knuth vs versão cúbica ---
+    std::cout << "--- Teste: Otimizacao de Knuth (O(n^2)) vs versao cubica ---" << std::endl;
+    std::mt19937 rng(2024);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    int n2 = 1000;
+    std::vector<double> p2(n2 + 1, 0.0), q2(n2 + 1);
+    double total = 0.0;
+    for (int i = 1; i <= n2; ++i) total += p2[i] = uniform(rng);
+    for (int i = 0; i <= n2; ++i) total += q2[i] = uniform(rng);
+    for (int i = 1; i <= n2; ++i) p2[i] /= total;
+    for (int i = 0; i <= n2; ++i) q2[i] /= total;
+
+    int root_mismatches = 0;
+    double max_diff = verifyOptimalBST(p2, q2, n2, root_mismatches);
+    std::cout << std::scientific << std::setprecision(2);
+    std::cout << "n = " << n2 << ": maior diferenca em e = " << max_diff
+              << ", raizes diferentes = " << root_mismatches << std::endl; // Esperado: 0 e 0 (mesmas somas do livro)
+
+    TriangularTable<double> e2;
+    TriangularTable<int> root2;
+    auto t0 = std::chrono::steady_clock::now();
+    optimalBST(p2, q2, n2, e2, root2);
+    auto t1 = std::chrono::steady_clock::now();
+    std::vector<std::vector<double>> e3, w3;
+    std::vector<std::vector<int>> root3;
+    optimalBSTCubic(p2, q2, n2, e3, w3, root3);
+    auto t2 = std::chrono::steady_clock::now();
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "Tempo: Knuth " << std::chrono::duration<double, std::milli>(t1 - t0).count()
+              << " ms, cubico " << std::chrono::duration<double, std::milli>(t2 - t1).count()
+              << " ms" << std::endl;
+
+    // Layout das tabelas em n = 5000: aninhado (n+2)^2 vs triangular por diagonal.
+    int n5 = 5000;
+    std::vector<double> p5(n5 + 1, 0.0), q5(n5 + 1);
+    double total5 = 0.0;
+    for (int i = 1; i <= n5; ++i) total5 += p5[i] = uniform(rng);
+    for (int i = 0; i <= n5; ++i) total5 += q5[i] = uniform(rng);
+    for (int i = 1; i <= n5; ++i) p5[i] /= total5;
+    for (int i = 0; i <= n5; ++i) q5[i] /= total5;
+    PerfCounter llc_misses(PerfCounter::CACHE_MISSES), l1_misses(PerfCounter::L1D_READ_MISSES);
+    auto counterText = [](long long count) { return count < 0 ? std::string("n/d") : std::to_string(count); };
+    auto timeLayout = [&](const char* label, auto& e5, auto& root5, double megabytes) {
+        llc_misses.start();
+        l1_misses.start();
+        auto start = std::chrono::steady_clock::now();
+        optimalBST(p5, q5, n5, e5, root5);
+        auto stop = std::chrono::steady_clock::now();
+        long long l1 = l1_misses.stop(), llc = llc_misses.stop();
+        std::cout << "\t" << label << ": " << megabytes << " MB, "
+                  << std::chrono::duration<double, std::milli>(stop - start).count() << " ms, faltas L1d "
+                  << counterText(l1) << ", faltas LLC " << counterText(llc) << ", e[1][n] = "
+                  << std::setprecision(6) << e5[1][n5] << std::setprecision(1) << std::endl;
+    };
+    std::cout << "n = " << n5 << ", layout das tabelas e, root:" << std::endl;
+    {
+        std::vector<std::vector<double>> e5;
+        std::vector<std::vector<int>> root5;
+        double megabytes = (n5 + 2.0) * (n5 + 2.0) * (sizeof(double) + sizeof(int)) / 1e6;
+        timeLayout("aninhado (n+2)^2       ", e5, root5, megabytes);
+    }
+    {
+        TriangularTable<double> e5;
+        TriangularTable<int> root5;
+        resizeIntervalTable(e5, n5);
+        double megabytes = (e5.bytes() + e5.data.size() * sizeof(int)) / 1e6;
+        timeLayout("triangular por diagonal", e5, root5, megabytes);
+    }
+    if (!llc_misses.available()) std::cout << "\t(contadores de hardware indisponiveis nesta maquina)" << std::endl;
+
+    // Varredura paralela das diagonais: as tabelas têm de sair idênticas, bit a bit.
+    std::cout << "n = " << n5 << ", varredura paralela (hardware_concurrency = "
+              << std::thread::hardware_concurrency() << "):" << std::endl;
+    {
+        TriangularTable<double> e_serial;
+        TriangularTable<int> root_serial;
+        auto start = std::chrono::steady_clock::now();
+        optimalBST(p5, q5, n5, e_serial, root_serial, 1);
+        auto stop = std::chrono::steady_clock::now();
+        double serial_ms = std::chrono::duration<double, std::milli>(stop - start).count();
+        std::cout << "\t1 thread : " << serial_ms << " ms" << std::endl;
+
+        // Identidade com 2 e 4 threads, sempre, qualquer que seja o número de
+        // núcleos: exercita parallelDiagonals mesmo onde não há o que medir.
+        for (int threads : {2, 4}) {
+            TriangularTable<double> e_parallel;
+            TriangularTable<int> root_parallel;
+            optimalBST(p5, q5, n5, e_parallel, root_parallel, threads);
+            bool identical = std::memcmp(e_parallel.data.data(), e_serial.data.data(), e_serial.bytes()) == 0 &&
+                             root_parallel.data == root_serial.data;
+            std::cout << "\t" << threads << " threads (forcadas): tabelas identicas: "
+                      << (identical ? "sim" : "NAO") << std::endl;
+        }
+
+        // Tempo: mais threads que núcleos só mediriam a troca de contexto.
+        int cores = (int)std::max(1u, std::thread::hardware_concurrency());
+        int measured = 1;
+        for (int wanted : {2, 4}) {
+            int threads = std::min(wanted, cores);
+            if (threads == measured) continue;
+            measured = threads;
+            TriangularTable<double> e_parallel;
+            TriangularTable<int> root_parallel;
+            start = std::chrono::steady_clock::now();
+            optimalBST(p5, q5, n5, e_parallel, root_parallel, threads);
+            stop = std::chrono::steady_clock::now();
+            double ms = std::chrono::duration<double, std::milli>(stop - start).count();
+            bool identical = std::memcmp(e_parallel.data.data(), e_serial.data.data(), e_serial.bytes()) == 0 &&
+                             root_parallel.data == root_serial.data;
+            std::cout << "\t" << threads << " threads: " << ms << " ms (serial / paralelo = " << serial_ms / ms
+                      << "x), tabelas identicas: " << (identical ? "sim" : "NAO") << std::endl;
+        }
+        if (cores == 1) std::cout << "\t(um nucleo so: tempo paralelo nao medido)" << std::endl;
+    }
+
+    // Memória para n = 50000: as três tabelas aninhadas do livro (e, w, root)
+    // vs e e root compactas, com w num vetor por diagonal.
+    double n50 = 50000;
+    std::cout << "Memoria para n = 50000: e, w, root aninhadas "
+              << (n50 + 2) * (n50 + 2) * (2 * sizeof(double) + sizeof(int)) / 1e9 << " GB; e, root compactas "
+              << (n50 + 1) * (n50 + 2) / 2 * (sizeof(double) + sizeof(int)) / 1e9 << " GB" << std::endl;
+    if (bench) {
+        // Com "--bench", uma instância grande de verdade (cerca de 2.4 GB).
+        int n_large = 20000;
+        std::vector<double> p_large(n_large + 1, 0.0), q_large(n_large + 1);
+        double total_large = 0.0;
+        for (int i = 1; i <= n_large; ++i) total_large += p_large[i] = uniform(rng);
+        for (int i = 0; i <= n_large; ++i) total_large += q_large[i] = uniform(rng);
+        for (int i = 1; i <= n_large; ++i) p_large[i] /= total_large;
+        for (int i = 0; i <= n_large; ++i) q_large[i] /= total_large;
+        TriangularTable<double> e_large;
+        TriangularTable<int> root_large;
+        t0 = std::chrono::steady_clock::now();
+        optimalBST(p_large, q_large, n_large, e_large, root_large);
+        t1 = std::chrono::steady_clock::now();
+        std::cout << "n = " << n_large << ": " << (e_large.bytes() + root_large.bytes()) / 1e9 << " GB, "
+                  << std::chrono::duration<double, std::milli>(t1 - t0).count() << " ms, e[1][n] = "
+                  << std::setprecision(6) << e_large[1][n_large] << std::setprecision(1) << std::endl;
+    }
+    std::cout << "---" << std::endl;
+
+    // --- Teste: Atualização incremental ---
+    std::cout << "--- Teste: Atualizacao incremental (so os intervalos afetados) ---" << std::endl;
+    int n_inc = 2000;
+    std::vector<double> p_inc(n_inc + 1, 0.0), q_inc(n_inc + 1);
+    for (int i = 1; i <= n_inc; ++i) p_inc[i] = uniform(rng);
+    for (int i = 0; i <= n_inc; ++i) q_inc[i] = uniform(rng);
+    OBSTState inc_state = obstBuild(p_inc, q_inc, n_inc);
+    // Compara o estado com um optimalBST completo sobre os pesos atuais.
+    auto compareFull = [&](double& full_ms) {
+        TriangularTable<double> e_full;
+        TriangularTable<int> root_full;
+        auto start = std::chrono::steady_clock::now();
+        optimalBST(inc_state.p, inc_state.q, n_inc, e_full, root_full);
+        auto stop = std::chrono::steady_clock::now();
+        full_ms = std::chrono::duration<double, std::milli>(stop - start).count();
+        double diff = 0.0;
+        int roots = 0;
+        for (size_t c = 0; c < e_full.data.size(); ++c) {
+            diff = std::max(diff, std::abs(e_full.data[c] - inc_state.e.data[c]));
+            roots += root_full.data[c] != inc_state.root.data[c];
+        }
+        std::cout << "maior diferenca em e " << std::scientific << std::setprecision(2) << diff
+                  << std::fixed << std::setprecision(1) << ", raizes diferentes " << roots;
+    };
+    long long total_cells = (long long)n_inc * (n_inc + 1) / 2;
+    for (int key : {10, n_inc / 2}) {
+        t0 = std::chrono::steady_clock::now();
+        obstUpdateKey(inc_state, key, 3 * inc_state.p[key] + 0.5);
+        t1 = std::chrono::steady_clock::now();
+        std::cout << "k" << key << " muda: " << inc_state.recomputed_cells << " de " << total_cells
+                  << " celulas, " << std::chrono::duration<double, std::milli>(t1 - t0).count() << " ms; ";
+        double full_ms;
+        compareFull(full_ms);
+        std::cout << " (completo: " << full_ms << " ms)" << std::endl; // Esperado: 0 e 0
+    }
+    // Lote de 50 mudanças (chaves e fictícias) numa passada.
+    std::vector<std::pair<int, double>> batch;
+    for (int u = 0; u < 50; ++u) batch.push_back({(int)(rng() % (2 * n_inc + 1)), uniform(rng)});
+    t0 = std::chrono::steady_clock::now();
+    obstUpdate(inc_state, batch);
+    t1 = std::chrono::steady_clock::now();
+    std::cout << "Lote de 50 pesos: " << inc_state.recomputed_cells << " celulas, "
+              << std::chrono::duration<double, std::milli>(t1 - t0).count() << " ms; ";
+    double batch_full_ms;
+    compareFull(batch_full_ms);
+    std::cout << std::endl;
+    std::cout << "---" << std::endl;
+
+    // --- Teste: Garsia-Wachs (p = 0) ---
+    std::cout << "--- Teste: Arvore alfabetica otima (Garsia-Wachs, p = 0) ---" << std::endl;
+    std::vector<double> p0(6, 0.0);
+    IntervalRoots gw_root;
+    TriangularTable<double> e0;
+    TriangularTable<int> root0;
+    optimalBST(p0, q, n, e0, root0);
+    double gw_cost = garsiaWachs(q, n, gw_root);
+    std::cout << "Exemplo do livro com p = 0: Garsia-Wachs " << gw_cost
+              << ", DP " << e0[1][n] << std::endl;
+    printOptimalStructure(gw_root, keys, dummies, 1, n, 0, false);
+
+    // Instâncias aleatórias contra a DP.
+    int gw_mismatches = 0;
+    for (int trial = 0; trial < 50; ++trial) {
+        int m = 1 + rng() % 200;
+        std::vector<double> pz(m + 1, 0.0), qz(m + 1);
+        for (double& x : qz) x = (trial % 5 == 0) ? 1.0 + rng() % 3 : uniform(rng);
+        TriangularTable<double> ez;
+        TriangularTable<int> rootz;
+        optimalBST(pz, qz, m, ez, rootz);
+        IntervalRoots rz;
+        if (std::abs(garsiaWachs(qz, m, rz) - ez[1][m]) > 1e-9 * ez[1][m]) gw_mismatches++;
+    }
+    std::cout << "50 instancias aleatorias, custo != DP: " << gw_mismatches << std::endl; // Esperado: 0
+
+    // Milhões de folhas: só O(n) de memória.
+    int big = 1000000;
+    std::vector<double> q_big(big + 1);
+    for (double& x : q_big) x = uniform(rng);
+    IntervalRoots big_root;
+    t0 = std::chrono::steady_clock::now();
+    double big_cost = garsiaWachs(q_big, big, big_root);
+    t1 = std::chrono::steady_clock::now();
+    std::cout << "n = " << big << " folhas: custo " << big_cost << ", raiz k" << big_root[1][big]
+              << ", tempo " << std::chrono::duration<double, std::milli>(t1 - t0).count() << " ms" << std::endl;
+    std::cout << "---" << std::endl;
+
+    // --- Teste: Bissecção de Mehlhorn vs ótimo ---
+    std::cout << "--- Teste: Arvore quase otima por bisseccao (Mehlhorn) ---" << std::endl;
+    IntervalRoots mh_root;
+    double mh_book = mehlhornBST(p, q, n, mh_root);
+    std::cout << std::setprecision(3);
+    std::cout << "Exemplo do livro: bisseccao " << mh_book << ", otimo " << e[1][n] << std::endl;
+    printOptimalStructure(mh_root, keys, dummies, 1, n, 0, false);
+
+    // Relatório nos tamanhos em que a DP exata cabe: uniforme (o mesmo do teste de Knuth)
+    // e uma distribuição Zipf, bem concentrada.
+    std::cout << "distribuicao  n     H      otimo  bissec.  limite inf.  limite sup." << std::endl;
+    for (int zipf = 0; zipf <= 1; ++zipf) {
+        std::vector<double> pr = p2, qr = q2;
+        if (zipf) {
+            std::vector<int> rank(2 * n2 + 1);
+            for (int t = 0; t <= 2 * n2; ++t) rank[t] = t + 1;
+            std::shuffle(rank.begin(), rank.end(), rng);
+            double z = 0.0;
+            for (int t = 0; t <= 2 * n2; ++t) z += 1.0 / rank[t];
+            for (int i = 1; i <= n2; ++i) pr[i] = 1.0 / rank[i - 1] / z;
+            for (int i = 0; i <= n2; ++i) qr[i] = 1.0 / rank[n2 + i] / z;
+        }
+        TriangularTable<double> er;
+        TriangularTable<int> rootr;
+        optimalBST(pr, qr, n2, er, rootr);
+        IntervalRoots mr;
+        double approx = mehlhornBST(pr, qr, n2, mr);
+        double h = accessEntropy(pr, qr, n2), sum_q = 0.0;
+        for (double x : qr) sum_q += x;
+        std::cout << (zipf ? "Zipf     " : "uniforme ") << "     " << n2 << "  " << h << "  "
+                  << er[1][n2] << "  " << approx << "    " << h / std::log2(3.0) + sum_q
+                  << "        " << h + 2 + sum_q << std::endl;
+    }
+
+    // Milhões de chaves: só a bissecção é viável.
+    int huge = 10000000;
+    std::vector<double> p_huge(huge + 1, 0.0), q_huge(huge + 1);
+    double huge_total = 0.0;
+    for (int i = 1; i <= huge; ++i) huge_total += p_huge[i] = uniform(rng);
+    for (int i = 0; i <= huge; ++i) huge_total += q_huge[i] = uniform(rng) / 4;
+    for (int i = 1; i <= huge; ++i) p_huge[i] /= huge_total;
+    for (int i = 0; i <= huge; ++i) q_huge[i] /= huge_total;
+    IntervalRoots huge_root;
+    t0 = std::chrono::steady_clock::now();
+    double huge_cost = mehlhornBST(p_huge, q_huge, huge, huge_root);
+    t1 = std::chrono::steady_clock::now();
+    double huge_q = 0.0;
+    for (double x : q_huge) huge_q += x;
+    std::cout << "n = " << huge << " chaves: custo " << huge_cost << " (limite sup. "
+              << accessEntropy(p_huge, q_huge, huge) + 2 + huge_q << "), tempo "
+              << std::setprecision(1) << std::chrono::duration<double, std::milli>(t1 - t0).count()
+              << " ms" << std::endl;
+    std::cout << "---" << std::endl;
+
+    // --- Teste: Árvore materializada para consultas ---
+    std::cout << "--- Teste: Arvore materializada (vetor de nos) vs std::map vs vetor ordenado ---" << std::endl;
+    std::vector<long long> key_values(n2 + 1);
+    for (int r = 1; r <= n2; ++r) key_values[r] = 2LL * r;
+    LookupTree exact_dfs = buildLookupTree(root2, key_values, p2, q2, n2, LAYOUT_DFS);
+    LookupTree exact_heavy = buildLookupTree(root2, key_values, p2, q2, n2, LAYOUT_HEAVY_FIRST);
+    bool lookup_ok = true;
+    for (int r = 1; r <= n2; ++r) {
+        lookup_ok = lookup_ok && exact_dfs.lookup(2LL * r) == r && exact_heavy.lookup(2LL * r) == r;
+    }
+    for (int g = 0; g <= n2; ++g) {
+        lookup_ok = lookup_ok && exact_dfs.lookup(2LL * g + 1) == -(g + 1)
+                              && exact_heavy.lookup(2LL * g + 1) == -(g + 1);
+    }
+    std::cout << "Todas as chaves e ficticias encontradas: " << (lookup_ok ? "OK" : "FALHOU") << std::endl;
+    std::cout << "n = " << n2 << " (arvore otima, pesos uniformes):" << std::endl;
+    benchmarkLookups(exact_dfs, exact_heavy, p2, q2, n2, 2000000, rng);
+
+    // Um milhão de chaves com acesso Zipf: árvore de Mehlhorn, bem maior que a cache.
+    int n_zipf = 1000000;
+    std::vector<double> p_zipf(n_zipf + 1, 0.0), q_zipf(n_zipf + 1);
+    std::vector<int> zipf_rank(2 * n_zipf + 1);
+    for (int t = 0; t <= 2 * n_zipf; ++t) zipf_rank[t] = t + 1;
+    std::shuffle(zipf_rank.begin(), zipf_rank.end(), rng);
+    double zipf_total = 0.0;
+    for (int t = 0; t <= 2 * n_zipf; ++t) zipf_total += 1.0 / zipf_rank[t];
+    for (int i = 1; i <= n_zipf; ++i) p_zipf[i] = 1.0 / zipf_rank[i - 1] / zipf_total;
+    for (int i = 0; i <= n_zipf; ++i) q_zipf[i] = 1.0 / zipf_rank[n_zipf + i] / zipf_total;
+    IntervalRoots zipf_root;
+    mehlhornBST(p_zipf, q_zipf, n_zipf, zipf_root);
+    std::vector<long long> zipf_keys(n_zipf + 1);
+    for (int r = 1; r <= n_zipf; ++r) zipf_keys[r] = 2LL * r;
+    LookupTree zipf_dfs = buildLookupTree(zipf_root, zipf_keys, p_zipf, q_zipf, n_zipf, LAYOUT_DFS);
+    LookupTree zipf_heavy = buildLookupTree(zipf_root, zipf_keys, p_zipf, q_zipf, n_zipf, LAYOUT_HEAVY_FIRST);
+    std::cout << "n = " << n_zipf << " (bisseccao, acesso Zipf):" << std::endl;
+    benchmarkLookups(zipf_dfs, zipf_heavy, p_zipf, q_zipf, n_zipf, 2000000, rng);
+    std::cout << "---" << std::endl;
+
+    // --- Teste: Exportação sem recursão ---
+    std::cout << "--- Teste: Exportacao da arvore (DOT, JSON, binario) ---" << std::endl;
+    std::cout << "Exemplo do livro em DOT:" << std::endl;
+    exportTree(std::cout, root, n, EXPORT_DOT);
+    std::cout << "Exemplo do livro em JSON:" << std::endl;
+    exportTree(std::cout, root, n, EXPORT_JSON);
+
+    // Confere o binário: percorrendo em ordem, têm de sair d0 k1 d1 k2 ... kn dn.
+    auto binaryInOrder = [](const std::string& bytes) {
+        if (bytes.size() < 12 || bytes.compare(0, 4, "OBST") != 0) return false;
+        int32_t header[2];
+        std::memcpy(header, bytes.data() + 4, sizeof(header));
+        int m = header[0];
+        if (bytes.size() != 12 + 8 * (size_t)m) return false;
+        std::vector<int32_t> children(2 * (size_t)m);
+        std::memcpy(children.data(), bytes.data() + 12, bytes.size() - 12);
+        int expected_key = 1, expected_gap = 0;
+        std::vector<int> stack;
+        int node = header[1];
+        while (true) {
+            // Desce pela esquerda até uma fictícia.
+            while (node > 0) {
+                stack.push_back(node);
+                node = children[2 * (size_t)(node - 1)];
+            }
+            if (-node - 1 != expected_gap++) return false;
+            if (stack.empty()) break;
+            int r = stack.back();
+            stack.pop_back();
+            if (r != expected_key++) return false;
+            node = children[2 * (size_t)(r - 1) + 1];
+        }
+        return expected_key == m + 1 && expected_gap == m + 1;
+    };
+
+    // Um milhão de nós: a árvore degenerada k1 -> k2 -> ... (sempre à direita)
+    // e a árvore de Mehlhorn com acesso Zipf do teste anterior.
+    int n_chain = 1000000;
+    std::vector<int> chain_first(n_chain), chain_last(n_chain, n_chain), chain_roots(n_chain);
+    for (int t = 0; t < n_chain; ++t) chain_first[t] = chain_roots[t] = t + 1;
+    IntervalRoots chain_root;
+    chain_root.assign(n_chain, chain_first, chain_last, chain_roots);
+    auto timeExport = [&](const char* label, const IntervalRoots& tree_root, int m) {
+        std::cout << label << ":";
+        for (ExportFormat format : {EXPORT_DOT, EXPORT_JSON, EXPORT_BINARY}) {
+            std::ostringstream sink;
+            auto start = std::chrono::steady_clock::now();
+            exportTree(sink, tree_root, m, format);
+            auto stop = std::chrono::steady_clock::now();
+            std::string bytes = sink.str();
+            std::cout << (format == EXPORT_DOT ? " DOT " : format == EXPORT_JSON ? " | JSON " : " | binario ")
+                      << std::chrono::duration<double, std::milli>(stop - start).count() << " ms ("
+                      << bytes.size() / 1e6 << " MB";
+            if (format == EXPORT_BINARY) std::cout << ", em ordem: " << (binaryInOrder(bytes) ? "OK" : "FALHOU");
+            std::cout << ")";
+        }
+        std::cout << std::endl;
+    };
+    timeExport("n = 10^6, degenerada", chain_root, n_chain);
+    timeExport("n = 10^6, Mehlhorn/Zipf", zipf_root, n_zipf);
+    std::cout << "---" << std::endl;
+
+    // --- Teste: Índice adaptativo (distribuição aprendida do tráfego) ---
+    std::cout << "--- Teste: Indice adaptativo (contagens ao vivo, reconstrucao e troca atomica) ---" << std::endl;
+    int n_live = 1000, reader_count = 2, per_phase = 1500000;
+    // Duas fases Zipf com rankings sorteados independentemente: o tráfego muda no meio.
+    std::vector<std::vector<double>> phase_weight(2, std::vector<double>(2 * n_live + 1));
+    for (std::vector<double>& weight : phase_weight) {
+        std::vector<int> rank(2 * n_live + 1);
+        for (int t = 0; t <= 2 * n_live; ++t) rank[t] = t + 1;
+        std::shuffle(rank.begin(), rank.end(), rng);
+        for (int t = 0; t <= 2 * n_live; ++t) weight[t] = 1.0 / rank[t];
+    }
+    // Cada leitor consulta a posição t da fila com o valor t + 1 (chave k_r = 2r, fictícia d_g = 2g + 1).
+    std::vector<std::vector<int>> trace(reader_count);
+    for (std::vector<int>& slots : trace) {
+        for (const std::vector<double>& weight : phase_weight) {
+            std::discrete_distribution<int> pick(weight.begin(), weight.end());
+            for (int s = 0; s < per_phase; ++s) slots.push_back(pick(rng));
+        }
+    }
+
+    std::vector<long long> live_keys(n_live + 1);
+    for (int r = 1; r <= n_live; ++r) live_keys[r] = 2LL * r;
+    AdaptiveIndex index(live_keys, n_live, reader_count, 2000);
+    std::atomic<bool> stop{false};
+    std::thread rebuilder([&] { index.rebuildLoop(stop, std::chrono::milliseconds(20), 0.03, 20000); });
+    std::vector<long long> wrong(reader_count, 0);
+    std::vector<std::thread> readers;
+    t0 = std::chrono::steady_clock::now();
+    for (int reader = 0; reader < reader_count; ++reader) {
+        readers.emplace_back([&, reader] {
+            long long errors = 0;
+            for (int t : trace[reader]) {
+                int expected = (t % 2 == 1) ? (t + 1) / 2 : -(t / 2 + 1);
+                if (index.lookup(reader, t + 1) != expected) errors++;
+            }
+            wrong[reader] = errors;
+        });
+    }
+    for (std::thread& reader : readers) reader.join();
+    t1 = std::chrono::steady_clock::now();
+    stop.store(true);
+    rebuilder.join();
+
+    long long total_wrong = 0;
+    for (long long x : wrong) total_wrong += x;
+    std::cout << std::setprecision(1);
+    std::cout << reader_count << " leitores, " << 2LL * per_phase * reader_count << " buscas em "
+              << std::chrono::duration<double, std::milli>(t1 - t0).count() << " ms, respostas erradas: "
+              << total_wrong << std::endl; // Esperado: 0
+    int rebuilds = 0;
+    std::cout << std::setprecision(3);
+    for (const RebuildEvent& event : index.log) {
+        if (!event.rebuilt) continue;
+        rebuilds++;
+        std::cout << "\tt = " << std::setprecision(0) << event.time_ms << " ms, janela de "
+                  << event.samples << " buscas: " << std::setprecision(3) << event.cost_current
+                  << " -> " << event.cost_probe << " nos/busca (sonda), reconstruiu" << std::endl;
+    }
+    std::cout << index.log.size() << " verificacoes, " << rebuilds << " reconstrucoes" << std::endl;
+
+    // Árvore final sob a distribuição real da fase 2 vs a inicial e a ótima para ela.
+    std::vector<double> p_live(n_live + 1, 0.0), q_live(n_live + 1);
+    double live_total = 0.0;
+    for (double x : phase_weight[1]) live_total += x;
+    for (int t = 0; t <= 2 * n_live; ++t) {
+        if (t % 2 == 0) q_live[t / 2] = phase_weight[1][t] / live_total;
+        else p_live[(t + 1) / 2] = phase_weight[1][t] / live_total;
+    }
+    std::vector<double> p_flat(n_live + 1, 1.0 / (2 * n_live + 1)), q_flat(n_live + 1, 1.0 / (2 * n_live + 1));
+    p_flat[0] = 0.0;
+    double cost_final = expectedVisits(slotVisits(*index.current.load(), n_live), p_live, q_live, n_live);
+    double cost_initial = expectedVisits(slotVisits(index.build(p_flat, q_flat), n_live), p_live, q_live, n_live);
+    double cost_best = expectedVisits(slotVisits(index.build(p_live, q_live), n_live), p_live, q_live, n_live);
+    std::cout << "Nos por busca na fase 2: arvore inicial " << cost_initial << ", final " << cost_final
+              << ", otima " << cost_best << std::endl;
+    std::cout << "---" << std::endl;
+
+    // --- Teste: Árvore em tempo de compilação ---
+    std::cout << "--- Teste: OBST em tempo de compilacao vs arvore em vetor vs hash perfeito ---" << std::endl;
+    std::cout << "Exemplo do livro (constexpr): raiz " << keys[BOOK_ROOTS.root[1][5]]
+              << ", custo " << BOOK_ROOTS.cost << std::endl; // Esperado: k2 e 2.750
+    std::cout << "Codigo gerado para o exemplo do livro (k_r = 10r):" << std::endl;
+    std::vector<long long> book_values = {0, 10, 20, 30, 40, 50};
+    emitDecisionTree(std::cout, root, book_values, n, "findBookKey");
+
+    // Códigos HTTP: a mesma tabela em constexpr e pelo optimalBST em tempo de execução.
+    std::vector<double> p_http(HTTP_P.begin(), HTTP_P.end()), q_http(HTTP_Q.begin(), HTTP_Q.end());
+    std::vector<long long> http_values(HTTP_CODES.begin(), HTTP_CODES.end());
+    TriangularTable<double> e_http;
+    TriangularTable<int> root_http;
+    optimalBST(p_http, q_http, HTTP_KEYS, e_http, root_http);
+    int static_mismatches = 0;
+    for (int i = 1; i <= HTTP_KEYS; ++i) {
+        for (int j = i; j <= HTTP_KEYS; ++j) static_mismatches += HTTP_ROOTS.root[i][j] != root_http[i][j];
+    }
+    std::cout << "Codigos HTTP (" << HTTP_KEYS << " chaves): raizes constexpr != optimalBST: "
+              << static_mismatches << std::endl; // Esperado: 0
+
+    LookupTree http_tree = buildLookupTree(root_http, http_values, p_http, q_http, HTTP_KEYS, LAYOUT_HEAVY_FIRST);
+    PerfectHash http_hash;
+    http_hash.build(http_values, HTTP_KEYS, rng);
+    using HttpDecision = StaticDecision<HTTP_CODES, HTTP_ROOTS, 1, HTTP_KEYS>;
+
+    // Posição t da fila: chave k_r (t = 2r - 1) ou um código desconhecido do intervalo d_g (t = 2g).
+    auto slotValue = [&](int t) -> long long {
+        if (t % 2 == 1) return HTTP_CODES[(t + 1) / 2];
+        int g = t / 2;
+        return g == 0 ? HTTP_CODES[1] - 1 : HTTP_CODES[g] + 1;
+    };
+    bool static_ok = true;
+    for (int t = 0; t <= 2 * HTTP_KEYS; ++t) {
+        if (t % 2 == 0 && HTTP_Q[t / 2] == 0.0) continue; // Intervalo sem inteiros
+        long long x = slotValue(t);
+        int expected = (t % 2 == 1) ? (t + 1) / 2 : -(t / 2 + 1);
+        static_ok = static_ok && HttpDecision::lookup(x) == expected && http_tree.lookup(x) == expected
+                              && http_hash.lookup(x) == std::max(expected, 0);
+    }
+    std::cout << "Todas as chaves e ficticias encontradas: " << (static_ok ? "OK" : "FALHOU") << std::endl;
+
+    std::vector<double> http_weight(2 * HTTP_KEYS + 1);
+    for (int t = 0; t <= 2 * HTTP_KEYS; ++t) http_weight[t] = (t % 2 == 0) ? HTTP_Q[t / 2] : HTTP_P[(t + 1) / 2];
+    std::discrete_distribution<int> pick_http(http_weight.begin(), http_weight.end());
+    int http_count = 10000000;
+    std::vector<long long> http_queries(http_count);
+    for (long long& x : http_queries) x = slotValue(pick_http(rng));
+    auto timeHttp = [&](const char* label, auto&& find) {
+        long long checksum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (long long x : http_queries) {
+            int r = find(x);
+            checksum += r > 0 ? r : 0;
+        }
+        auto stop = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(stop - start).count() / http_count;
+        std::cout << "\t" << label << ": " << ns << " ns/consulta (checksum " << checksum << ")" << std::endl;
+    };
+    timeHttp("if/else em compilacao", [](long long x) { return HttpDecision::lookup(x); });
+    timeHttp("arvore plana (vetor)  ", [&](long long x) { return http_tree.lookup(x); });
+    timeHttp("hash perfeito         ", [&](long long x) { return http_hash.lookup(x); });
+    std::cout << "---" << std::endl;
     
     return 0;
 }
\ No newline at end of file
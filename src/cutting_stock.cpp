@@ -0,0 +1,701 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <map>
+#include <utility>   // Para std::pair
+#include <algorithm> // Para std::max, std::sort
+#include <cmath>     // Para std::floor, std::ceil
+#include <chrono>    // Para medir o tempo do teste grande
+#include <random>    // Para gerar instâncias grandes
+#include <stdexcept> // Para std::invalid_argument
+#include <set>       // Para contar os comprimentos distintos no teste grande
+
+/**
+ * @brief Um tipo de peça pedido pela produção.
+ */
+struct PieceType {
+    int length; // Comprimento da peça (precisa ser <= comprimento da barra)
+    int demand; // Quantidade pedida
+};
+
+/**
+ * @brief Um padrão de corte: quantas peças de cada tipo saem de uma barra.
+ * Guardado de forma esparsa, pois cada padrão usa poucos tipos.
+ */
+typedef std::vector<std::pair<int, int>> Pattern; // (índice do tipo, quantidade)
+
+/**
+ * @brief Resultado do planejamento de corte.
+ */
+struct CuttingPlan {
+    std::vector<Pattern> patterns; // Padrões distintos usados
+    std::vector<int> rolls;        // rolls[t] = quantas barras cortamos com patterns[t]
+    double lp_bound;               // Limite inferior provado (Farley ou material), nunca um valor primal
+    double lp_value;               // Valor primal do mestre na demanda original
+    bool lp_optimal;               // true -> lp_value é o ótimo da relaxação (e lp_bound coincide)
+    int total_rolls;               // Total de barras usadas
+    long long waste;               // Material perdido (soma das sobras de cada barra)
+};
+
+/**
+ * @brief Buffers do subproblema de preço, reaproveitados entre iterações.
+ *
+ * A geração de colunas chama o subproblema centenas de vezes com o mesmo W.
+ * Além de evitar realocar O(W) a cada chamada, a tabela val da chamada
+ * anterior é reaproveitada: val[j] só depende das peças de comprimento <= j,
+ * então se os preços de todos os comprimentos abaixo de L0 não mudaram,
+ * val[0..L0-1] continua valendo e a DP recomeça em L0. Na geração de colunas
+ * quase todos os duais mudam a cada rodada, então o ganho medido é pequeno
+ * (~8% das células no teste de 200 tipos, a maior parte nos re-solves do
+ * mergulho).
+ */
+struct PricingWorkspace {
+    int W = -1;                   // Comprimento da barra da tabela guardada (-1 = nenhuma)
+    std::vector<double> val;      // val[j] = maior valor dual cabendo numa barra de comprimento j
+    std::vector<int> best_piece;  // best_piece[L] = tipo de comprimento L com maior dual
+    std::vector<int> lengths;     // Comprimentos distintos com dual positivo (não dominados)
+    std::vector<double> prices;   // prices[k] = dual do melhor tipo com comprimento lengths[k]
+    std::vector<int> last_lengths;   // 'lengths' da chamada anterior
+    std::vector<double> last_prices; // 'prices' da chamada anterior
+};
+
+/**
+ * @brief Subproblema de preço da geração de colunas: mochila ilimitada.
+ *
+ * É o cutRod generalizado: o "preço" de um pedaço de comprimento L passa a ser
+ * o maior valor dual y_i entre os tipos com esse comprimento, e sobras são
+ * permitidas (val[j] >= val[j-1]). O ótimo é o mesmo da recorrência
+ * val[j] = max( val[j-1], max_L { preço(L) + val[j-L] } ), mas a tabela é
+ * preenchida peça a peça (para cada L, j crescente), como na mochila
+ * ilimitada clássica: o laço interno vira um max sem desvios, que o
+ * compilador vetoriza. O padrão é reconstruído depois, procurando em cada j
+ * um pedaço que explique val[j].
+ *
+ * @param pieces Tipos de peça.
+ * @param duals Valores duais y_i da demanda de cada tipo.
+ * @param W Comprimento da barra.
+ * @param ws Buffers reaproveitados (e a tabela da chamada anterior).
+ * @param pattern Recebe o padrão de maior valor dual.
+ * @return double O valor dual do padrão (sum y_i * a_i).
+ */
+double priceCutPattern(const std::vector<PieceType>& pieces,
+                       const std::vector<double>& duals,
+                       int W, PricingWorkspace& ws, Pattern& pattern) {
+
+    const double eps = 1e-12;
+    ws.best_piece.assign(W + 1, -1);
+    ws.lengths.clear();
+
+    // --- Passo 1: Preço de cada comprimento (o melhor dual entre os tipos) ---
+    for (int t = 0; t < (int)pieces.size(); t++) {
+        int L = pieces[t].length;
+        if (duals[t] <= eps || L > W) {
+            continue; // Peças sem valor dual não ajudam o padrão.
+        }
+        if (ws.best_piece[L] < 0) {
+            ws.lengths.push_back(L);
+            ws.best_piece[L] = t;
+        } else if (duals[t] > duals[ws.best_piece[L]]) {
+            ws.best_piece[L] = t;
+        }
+    }
+
+    // --- Passo 2: Remove comprimentos dominados ---
+    // Se um pedaço mais curto vale pelo menos o mesmo, o mais longo nunca
+    // é necessário (basta o curto + sobra). Ficam só preços estritamente
+    // crescentes no comprimento, guardados de forma contígua.
+    std::sort(ws.lengths.begin(), ws.lengths.end());
+    ws.prices.clear();
+    int kept = 0;
+    for (int L : ws.lengths) {
+        double price = duals[ws.best_piece[L]];
+        if (kept == 0 || price > ws.prices[kept - 1] + eps) {
+            ws.lengths[kept++] = L;
+            ws.prices.push_back(price);
+        }
+    }
+    ws.lengths.resize(kept);
+
+    // --- Passo 3: Partida a quente ---
+    // start = menor comprimento cujo preço mudou desde a chamada anterior;
+    // val[0..start-1] só depende dos pedaços mais curtos e fica como está.
+    int start = 0;
+    if (ws.W == W) {
+        size_t k = 0;
+        while (k < ws.lengths.size() && k < ws.last_lengths.size()
+               && ws.lengths[k] == ws.last_lengths[k] && ws.prices[k] == ws.last_prices[k]) {
+            k++;
+        }
+        start = W + 1;
+        if (k < ws.lengths.size()) start = std::min(start, ws.lengths[k]);
+        if (k < ws.last_lengths.size()) start = std::min(start, ws.last_lengths[k]);
+    }
+    ws.W = W;
+    ws.last_lengths = ws.lengths;
+    ws.last_prices = ws.prices;
+    ws.val.resize(W + 1);
+    std::fill(ws.val.begin() + start, ws.val.end(), 0.0);
+
+    // --- Passo 4: Tabela peça a peça (mochila ilimitada) ---
+    double* val = ws.val.data();
+    for (int k = 0; k < kept; k++) {
+        int L = ws.lengths[k];
+        double price = ws.prices[k];
+        for (int j = std::max(L, start); j <= W; j++) {
+            val[j] = std::max(val[j], val[j - L] + price);
+        }
+    }
+
+    // --- Passo 5: Reconstrói o padrão ---
+    // Em cada j, ou val[j] = val[j-1] (1 unidade de sobra), ou algum pedaço
+    // L tem preço(L) + val[j-L] = val[j].
+    std::map<int, int> counts;
+    int j = W;
+    while (j > 0) {
+        if (val[j] <= val[j - 1]) {
+            j--;
+            continue;
+        }
+        int k = 0;
+        while (k < kept && ws.lengths[k] <= j
+               && ws.prices[k] + val[j - ws.lengths[k]] < val[j] - 1e-9) {
+            k++;
+        }
+        if (k == kept || ws.lengths[k] > j) {
+            j--; // Não acontece: val[j] > val[j-1] vem de algum pedaço.
+            continue;
+        }
+        counts[ws.best_piece[ws.lengths[k]]]++;
+        j -= ws.lengths[k];
+    }
+    pattern = Pattern(counts.begin(), counts.end());
+    return val[W];
+}
+
+/**
+ * @brief Base do simplex do problema mestre, guardada entre re-soluções.
+ */
+struct MasterBasis {
+    std::vector<int> basis;    // basis[i] = coluna básica da linha i
+    std::vector<double> Binv;  // Inversa da base (m x m, por linhas)
+    bool ready = false;        // false -> começa da base homogênea
+};
+
+/**
+ * @brief Resultado de uma resolução do mestre.
+ */
+struct MasterResult {
+    double objective;   // Valor primal sum x_p da base final
+    double lower_bound; // Limite inferior provado para o ótimo do LP
+    bool optimal;       // false -> parou sem provar otimalidade (prazo, limite de pivôs ou erro numérico)
+};
+
+/**
+ * @brief Resolve a relaxação linear do problema mestre por geração de colunas.
+ *
+ * Mestre: min sum x_p  s.a.  sum_p a_ip x_p >= d_i,  x >= 0.
+ * Usamos o simplex revisado com a inversa da base explícita (m x m). A base
+ * inicial são os padrões homogêneos (floor(W / l_i) peças do tipo i), que
+ * formam uma base diagonal viável. A coluna que entra é a de menor custo
+ * reduzido no pool (Dantzig); depois de muitos pivôs degenerados seguidos
+ * usamos a regra de Bland (a primeira que melhora), que não cicla. Quando
+ * nenhuma coluna do pool melhora, chamamos priceCutPattern com os duais.
+ *
+ * Partida a quente: se 'lp' já tem uma base, só recalculamos x_B = B^{-1} d.
+ * Depois de abater floor(x) da demanda, a base anterior continua viável
+ * (sobram só as partes fracionárias), então o re-solve custa poucos pivôs.
+ * O pool de colunas também é mantido, e o subproblema de preço só é chamado
+ * quando as colunas conhecidas se esgotam (cada chamada devolve uma coluna,
+ * como em Gilmore-Gomory).
+ *
+ * Limite inferior: o valor primal só é o ótimo se a última chamada de preço
+ * provar que nenhum padrão tem custo reduzido negativo. Por isso guardamos à
+ * parte o limite de Farley, válido em qualquer iteração: com pi = max(y, 0) e
+ * V = max_p pi . a_p (o próprio valor do subproblema), todo x viável tem
+ * sum x_p >= sum x_p (pi . a_p) / V >= pi . d / V. O limite material
+ * sum d_i l_i / W é o ponto de partida. Se o prazo acaba, devolvemos a base
+ * atual (sempre viável) com esse limite.
+ *
+ * Custo: B^{-1} é densa, então cada pivô custa O(m^2), e o número de pivôs
+ * cresce mais rápido que m. É um mestre para centenas de comprimentos
+ * distintos, não milhares (tempos no Teste 2 de main).
+ *
+ * @param pieces Tipos de peça.
+ * @param demand Demanda a cobrir (pode ser a residual).
+ * @param W Comprimento da barra.
+ * @param pool Padrões conhecidos (entrada e saída).
+ * @param ws Buffers do subproblema de preço.
+ * @param lp Base do simplex (entrada e saída).
+ * @param x Recebe x[p] para cada padrão do pool.
+ * @param deadline Momento em que a geração de colunas para, provada ou não.
+ * @return MasterResult Valor primal, limite inferior provado e se o ótimo foi provado.
+ */
+MasterResult solveMasterLP(const std::vector<PieceType>& pieces,
+                     const std::vector<int>& demand,
+                     int W, std::vector<Pattern>& pool,
+                     PricingWorkspace& ws, MasterBasis& lp,
+                     std::vector<double>& x,
+                     std::chrono::steady_clock::time_point deadline) {
+
+    const double eps = 1e-9;
+    int m = pieces.size();
+    const int SLACK = 1 << 30; // Colunas de folga (-e_i) têm id SLACK + i
+
+    std::map<Pattern, int> known;
+    for (int p = 0; p < (int)pool.size(); p++) {
+        known[pool[p]] = p;
+    }
+    std::vector<int>& basis = lp.basis;
+    std::vector<double>& Binv = lp.Binv;
+    std::vector<double> xB(m);
+
+    if (!lp.ready) {
+        // --- Passo 1a: Base inicial com os padrões homogêneos ---
+        // Garantimos que o padrão homogêneo de cada tipo está no pool.
+        basis.assign(m, 0);
+        Binv.assign((size_t)m * m, 0.0);
+        for (int i = 0; i < m; i++) {
+            int copies = W / pieces[i].length;
+            Pattern homogeneous = {{i, copies}};
+            if (known.count(homogeneous) == 0) {
+                known[homogeneous] = pool.size();
+                pool.push_back(homogeneous);
+            }
+            basis[i] = known[homogeneous];
+            Binv[(size_t)i * m + i] = 1.0 / copies;
+        }
+        lp.ready = true;
+    }
+
+    // --- Passo 1b: x_B = B^{-1} d ---
+    for (int i = 0; i < m; i++) {
+        const double* row = &Binv[(size_t)i * m];
+        double sum = 0.0;
+        for (int k = 0; k < m; k++) {
+            sum += row[k] * demand[k];
+        }
+        xB[i] = std::max(0.0, sum); // Remove resíduos numéricos negativos
+    }
+
+    std::vector<double> y(m), u(m);
+    std::vector<char> in_basis(pool.size(), 0);
+    for (int i = 0; i < m; i++) {
+        if (basis[i] < SLACK) in_basis[basis[i]] = 1;
+    }
+
+    // --- Passo 2: Iterações do simplex revisado ---
+    int degenerate = 0;
+    bool refresh = true;
+    bool optimal = false;
+    double lower_bound = 0.0;
+    for (int i = 0; i < m; i++) {
+        lower_bound += (double)demand[i] * pieces[i].length;
+    }
+    lower_bound /= W;
+    for (int iter = 0; iter < 1000 * (m + 10); iter++) {
+
+        // Duais: y = c_B^T B^{-1} (c = 1 para padrões, 0 para folgas).
+        // Recalculados do zero a cada 64 pivôs; entre eles, atualização O(m).
+        bool exact_y = iter % 64 == 0 || refresh;
+        if (exact_y) {
+            refresh = false;
+            std::fill(y.begin(), y.end(), 0.0);
+            for (int i = 0; i < m; i++) {
+                if (basis[i] < SLACK) {
+                    const double* row = &Binv[(size_t)i * m];
+                    for (int k = 0; k < m; k++) {
+                        y[k] += row[k];
+                    }
+                }
+            }
+        }
+
+        // Escolhe a coluna que entra (Dantzig, ou Bland se estiver degenerando).
+        bool bland = degenerate > 20;
+        int entering = -1;
+        double best_rc = -eps;
+        for (int p = 0; p < (int)pool.size() && !(bland && entering >= 0); p++) {
+            if (in_basis[p]) continue;
+            double rc = 1.0;
+            for (const auto& [t, count] : pool[p]) {
+                rc -= y[t] * count;
+            }
+            if (rc < best_rc) {
+                best_rc = rc;
+                entering = p;
+            }
+        }
+        for (int i = 0; i < m && !(bland && entering >= 0); i++) {
+            // Custo reduzido da folga -e_i é y_i.
+            if (y[i] < best_rc) {
+                best_rc = y[i];
+                entering = SLACK + i;
+            }
+        }
+
+        // Nenhuma coluna conhecida melhora: pergunta ao subproblema de preço.
+        // (Antes, garantimos que y não carrega erro acumulado das atualizações.)
+        if (entering < 0 && !exact_y) {
+            refresh = true;
+            continue;
+        }
+        if (entering < 0) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                break; // Prazo esgotado: fica o limite de Farley.
+            }
+            Pattern fresh;
+            double value = priceCutPattern(pieces, y, W, ws, fresh);
+
+            // Limite de Farley com pi = y nos tipos com y > 0 (os mesmos que o
+            // subproblema considera). A folga relativa cobre as tolerâncias da DP.
+            double dual_demand = 0.0;
+            for (int i = 0; i < m; i++) {
+                if (y[i] > 1e-12) dual_demand += y[i] * demand[i];
+            }
+            if (value > 0.0) {
+                lower_bound = std::max(lower_bound, dual_demand / (value * (1.0 + 1e-9)));
+            }
+
+            if (1.0 - value >= -eps) {
+                optimal = true;
+                break; // Ótimo da relaxação.
+            }
+            auto it = known.find(fresh);
+            if (it != known.end() && in_basis[it->second]) {
+                // Uma coluna básica com custo reduzido negativo em duais exatos:
+                // erro numérico em B^{-1}. Paramos sem declarar o ótimo.
+                break;
+            }
+            if (it != known.end()) {
+                entering = it->second;
+            } else {
+                known[fresh] = pool.size();
+                entering = pool.size();
+                pool.push_back(fresh);
+                in_basis.push_back(0);
+            }
+            best_rc = 1.0 - value;
+        }
+
+        // u = B^{-1} a, aproveitando que a coluna é esparsa.
+        for (int i = 0; i < m; i++) {
+            const double* row = &Binv[(size_t)i * m];
+            double sum = 0.0;
+            if (entering >= SLACK) {
+                sum = -row[entering - SLACK];
+            } else {
+                for (const auto& [t, count] : pool[entering]) {
+                    sum += row[t] * count;
+                }
+            }
+            u[i] = sum;
+        }
+
+        // Teste da razão. Pivôs muito pequenos são ignorados (estabilidade);
+        // em empates preferimos o maior pivô, ou o menor índice no modo Bland.
+        const double pivot_tol = 1e-7;
+        int leave = -1;
+        double best_ratio = 0.0;
+        for (int i = 0; i < m; i++) {
+            if (u[i] > pivot_tol) {
+                double ratio = xB[i] / u[i];
+                bool tie = leave >= 0 && std::abs(ratio - best_ratio) <= eps;
+                bool better_tie = tie && (bland ? basis[i] < basis[leave] : u[i] > u[leave]);
+                if (leave < 0 || ratio < best_ratio - eps || better_tie) {
+                    best_ratio = std::min(ratio, leave < 0 ? ratio : best_ratio);
+                    leave = i;
+                }
+            }
+        }
+        if (leave < 0) {
+            break; // Não acontece: o mestre é sempre limitado.
+        }
+        degenerate = best_ratio < eps ? degenerate + 1 : 0;
+
+        // Pivoteamento na linha 'leave'.
+        double* prow = &Binv[(size_t)leave * m];
+        double pivot = u[leave];
+        for (int k = 0; k < m; k++) prow[k] /= pivot;
+        xB[leave] /= pivot;
+        for (int i = 0; i < m; i++) {
+            if (i == leave || u[i] == 0.0) continue;
+            double f = u[i];
+            double* row = &Binv[(size_t)i * m];
+            for (int k = 0; k < m; k++) row[k] -= f * prow[k];
+            xB[i] -= f * xB[leave];
+        }
+        if (basis[leave] < SLACK) in_basis[basis[leave]] = 0;
+        basis[leave] = entering;
+        if (entering < SLACK) in_basis[entering] = 1;
+
+        // y' = y + rc * (nova linha 'leave' de B^{-1}); zera o custo reduzido de quem entrou.
+        for (int k = 0; k < m; k++) {
+            y[k] += best_rc * prow[k];
+        }
+    }
+
+    // --- Passo 3: Solução primal ---
+    x.assign(pool.size(), 0.0);
+    double objective = 0.0;
+    for (int i = 0; i < m; i++) {
+        if (basis[i] < SLACK) {
+            double value = std::max(0.0, xB[i]);
+            x[basis[i]] = value;
+            objective += value;
+        }
+    }
+    if (optimal) {
+        // O ótimo também é um limite; evita mostrar um Farley arredondado abaixo dele.
+        lower_bound = std::max(lower_bound, objective * (1.0 - 1e-9));
+    }
+    return {objective, std::min(lower_bound, objective), optimal};
+}
+
+/**
+ * @brief Cutting-stock 1D: atende às demandas com o menor número de barras.
+ *
+ * 0. Tipos de mesmo comprimento são intercambiáveis no corte: o mestre tem
+ *    uma linha por comprimento distinto (com a demanda somada), e só o plano
+ *    final volta a ser escrito com os tipos originais.
+ * 1. Geração de colunas (solveMasterLP) sobre a demanda residual.
+ * 2. Mergulho ("diving"): fixa floor(x_p) barras de cada padrão, abate a
+ *    produção da demanda e re-resolve a residual a partir da base anterior,
+ *    até nenhum x_p chegar a 1 (ou 'max_rounds' rodadas).
+ * 3. A demanda residual (só partes fracionárias, em geral poucas barras) é
+ *    completada com First-Fit Decreasing.
+ *
+ * @param pieces Tipos de peça (cada comprimento em (0, W], demanda >= 0).
+ * @param W Comprimento da barra de estoque.
+ * @param max_rounds Máximo de rodadas de arredondamento antes do FFD final.
+ * @param time_limit Prazo em segundos para a geração de colunas (<= 0 = sem
+ * prazo). Esgotado, o mergulho e o FFD seguem com o pool que houver, e o
+ * plano continua viável.
+ * @return CuttingPlan O plano inteiro e o limite inferior da relaxação.
+ * @throws std::invalid_argument Se alguma peça não cabe na barra ou tem comprimento <= 0.
+ */
+CuttingPlan cuttingStock(const std::vector<PieceType>& pieces, int W, int max_rounds = 5,
+                         double time_limit = 0.0) {
+
+    int m = pieces.size();
+    // Uma peça maior que W daria um padrão homogêneo com 0 cópias (coluna nula
+    // no pool) e nenhuma forma de cobrir a demanda, e comprimento <= 0 divide
+    // por zero em W / l.
+    for (int i = 0; i < m; i++) {
+        if (pieces[i].length <= 0 || pieces[i].length > W || pieces[i].demand < 0) {
+            throw std::invalid_argument("peca " + std::to_string(i) + " com comprimento fora de (0, W] ou demanda negativa");
+        }
+    }
+
+    // --- Agrupa os tipos por comprimento ---
+    std::map<int, int> group_of_length;
+    std::vector<PieceType> groups;      // Um "tipo" por comprimento distinto
+    std::vector<std::vector<int>> members;
+    for (int i = 0; i < m; i++) {
+        auto it = group_of_length.find(pieces[i].length);
+        if (it == group_of_length.end()) {
+            it = group_of_length.insert({pieces[i].length, (int)groups.size()}).first;
+            groups.push_back({pieces[i].length, 0});
+            members.push_back({});
+        }
+        groups[it->second].demand += pieces[i].demand;
+        members[it->second].push_back(i);
+    }
+    int n = groups.size();
+
+    std::vector<int> residual(n);
+    for (int g = 0; g < n; g++) {
+        residual[g] = groups[g].demand;
+    }
+
+    std::vector<Pattern> pool;
+    PricingWorkspace ws;
+    MasterBasis lp;
+    std::vector<double> x;
+    std::map<Pattern, int> used; // padrão -> número de barras
+
+    CuttingPlan plan;
+    auto deadline = std::chrono::steady_clock::time_point::max();
+    if (time_limit > 0.0) {
+        deadline = std::chrono::steady_clock::now()
+                 + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(time_limit));
+    }
+    MasterResult first = solveMasterLP(groups, residual, W, pool, ws, lp, x, deadline);
+    plan.lp_value = first.objective;
+    plan.lp_bound = first.lower_bound;
+    plan.lp_optimal = first.optimal;
+
+    auto apply = [&](const Pattern& pattern, int copies) {
+        used[pattern] += copies;
+        for (const auto& [t, count] : pattern) {
+            residual[t] = std::max(0, residual[t] - count * copies);
+        }
+    };
+    auto remaining = [&]() {
+        for (int d : residual) if (d > 0) return true;
+        return false;
+    };
+
+    // --- Mergulho: arredonda para baixo e re-resolve a demanda residual ---
+    // Cada rodada parte da base anterior (continua viável), então custa poucos pivôs.
+    for (int round = 0; round < max_rounds && remaining(); round++) {
+        if (round > 0) {
+            solveMasterLP(groups, residual, W, pool, ws, lp, x, deadline);
+        }
+
+        bool fixed_any = false;
+        for (int p = 0; p < (int)pool.size(); p++) {
+            // Tolerância para valores como 2.9999999 (que são 3).
+            int copies = (int)std::floor(x[p] + 1e-9);
+            if (copies > 0) {
+                apply(pool[p], copies);
+                fixed_any = true;
+            }
+        }
+        if (!fixed_any) {
+            break; // Só restam partes fracionárias: o FFD cuida delas.
+        }
+    }
+
+    // --- First-Fit Decreasing para o que restar ---
+    std::vector<int> order(n);
+    for (int g = 0; g < n; g++) order[g] = g;
+    std::sort(order.begin(), order.end(),
+              [&](int a, int b) { return groups[a].length > groups[b].length; });
+    while (remaining()) {
+        std::map<int, int> counts;
+        int free_space = W;
+        for (int t : order) {
+            // Cada tipo é visitado uma vez, então counts[t] ainda não existe aqui
+            // (usar counts[t] criaria entradas "0 x L" no padrão).
+            int fit = std::min(residual[t], free_space / groups[t].length);
+            if (fit > 0) {
+                counts[t] += fit;
+                free_space -= fit * groups[t].length;
+            }
+        }
+        apply(Pattern(counts.begin(), counts.end()), 1);
+    }
+
+    // --- Volta aos tipos originais ---
+    // Barra a barra, cada peça de um comprimento vai para o primeiro tipo do
+    // grupo que ainda tem demanda; a produção além da demanda fica com o último.
+    std::vector<int> left(m);
+    for (int i = 0; i < m; i++) left[i] = pieces[i].demand;
+    std::vector<size_t> next(n, 0);
+    std::map<Pattern, int> by_type;
+    for (const auto& [pattern, copies] : used) {
+        for (int copy = 0; copy < copies; copy++) {
+            std::map<int, int> counts;
+            for (const auto& [g, count] : pattern) {
+                for (int c = 0; c < count; c++) {
+                    size_t& k = next[g];
+                    while (k + 1 < members[g].size() && left[members[g][k]] == 0) k++;
+                    int t = members[g][k];
+                    counts[t]++;
+                    left[t] = std::max(0, left[t] - 1);
+                }
+            }
+            by_type[Pattern(counts.begin(), counts.end())]++;
+        }
+    }
+
+    // --- Consolida o plano ---
+    plan.total_rolls = 0;
+    plan.waste = 0;
+    for (const auto& [pattern, copies] : by_type) {
+        int length_used = 0;
+        for (const auto& [t, count] : pattern) {
+            length_used += pieces[t].length * count;
+        }
+        plan.patterns.push_back(pattern);
+        plan.rolls.push_back(copies);
+        plan.total_rolls += copies;
+        plan.waste += (long long)(W - length_used) * copies;
+    }
+    return plan;
+}
+
+/**
+ * @brief Imprime os padrões do plano (uma linha por padrão).
+ */
+void printCuttingPlan(const CuttingPlan& plan, const std::vector<PieceType>& pieces) {
+    for (size_t t = 0; t < plan.patterns.size(); t++) {
+        std::cout << "\t" << plan.rolls[t] << " x [";
+        bool first = true;
+        for (const auto& [type, count] : plan.patterns[t]) {
+            std::cout << (first ? "" : ", ") << count << " x " << pieces[type].length;
+            first = false;
+        }
+        std::cout << "]" << '\n';
+    }
+}
+
+// Main para teste
+int main(int argc, char* argv[]) {
+    std::cout << "---" << std::endl;
+    std::cout << "Algoritmo: Cutting-Stock 1D (Gilmore-Gomory)" << std::endl;
+    std::cout << "Geracao de colunas com o cutRod (mochila ilimitada) como subproblema" << std::endl;
+    std::cout << "---" << std::endl;
+
+    // --- Teste 1: Exemplo clássico ---
+    // Barras de 100; peças de 45, 36, 31 e 14 com demandas 97, 610, 395 e 211.
+    std::cout << "--- Teste 1: Exemplo classico (W = 100) ---" << std::endl;
+    std::vector<PieceType> pieces1 = {{45, 97}, {36, 610}, {31, 395}, {14, 211}};
+    CuttingPlan plan1 = cuttingStock(pieces1, 100);
+    std::cout << "Limite da relaxacao linear: " << plan1.lp_bound << std::endl; // Esperado: 452.25
+    std::cout << "Otimo do LP provado: " << (plan1.lp_optimal ? "sim" : "nao") << std::endl;
+    std::cout << "Barras usadas: " << plan1.total_rolls << std::endl;           // Esperado: 453 (ou muito perto)
+    std::cout << "Perda total: " << plan1.waste << std::endl;
+    std::cout << "Padroes:" << std::endl;
+    printCuttingPlan(plan1, pieces1);
+    std::cout << "---" << std::endl;
+
+    // --- Teste 2: Instância aleatória com muitos tipos ---
+    // Comprimentos quaisquer em [500, 4500), W = 10000. Sem argumentos: 200
+    // tipos (~1.5 s, ótimo do LP provado; 400 tipos levam ~12 s). Com
+    // "--bench": 2000 tipos (~1590 comprimentos distintos) com prazo de 60 s
+    // para a geração de colunas; o mestre denso não chega ao ótimo nesse
+    // prazo, e o teste mostra o tempo real e a distância ao limite provado.
+    bool bench = argc > 1 && std::string(argv[1]) == "--bench";
+    int types = bench ? 2000 : 200;
+    double time_limit = bench ? 60.0 : 0.0;
+    int W2 = 10000;
+    std::mt19937 rng(42);
+    std::vector<PieceType> pieces2(types);
+    for (PieceType& piece : pieces2) {
+        piece.length = 500 + rng() % 4000;
+        piece.demand = 1 + rng() % 50;
+    }
+
+    std::set<int> distinct;
+    for (const PieceType& piece : pieces2) distinct.insert(piece.length);
+    std::cout << "--- Teste 2: " << types << " tipos de peca (W = " << W2 << ") ---" << std::endl;
+    std::cout << "Comprimentos distintos: " << distinct.size() << std::endl;
+    auto start = std::chrono::steady_clock::now();
+    CuttingPlan plan2 = cuttingStock(pieces2, W2, 5, time_limit);
+    auto end = std::chrono::steady_clock::now();
+    std::cout << "Limite inferior provado: " << plan2.lp_bound << std::endl;
+    std::cout << "Otimo do LP provado: " << (plan2.lp_optimal ? "sim" : "nao") << std::endl;
+    if (!plan2.lp_optimal) {
+        std::cout << "Valor primal do LP: " << plan2.lp_value << " (gap "
+                  << 100.0 * (plan2.lp_value - plan2.lp_bound) / plan2.lp_bound << "%)" << std::endl;
+    }
+    double integer_bound = std::ceil(plan2.lp_bound - 1e-9);
+    std::cout << "Barras usadas: " << plan2.total_rolls << " (gap para ceil(limite): "
+              << 100.0 * (plan2.total_rolls - integer_bound) / integer_bound << "%)" << std::endl;
+    std::cout << "Padroes distintos: " << plan2.patterns.size() << std::endl;
+    std::cout << "Tempo: " << std::chrono::duration<double>(end - start).count() << " s" << std::endl;
+    std::cout << "---" << std::endl;
+
+    // --- Teste 3: Entrada inválida ---
+    std::cout << "--- Teste 3: Peca maior que a barra ---" << std::endl;
+    try {
+        cuttingStock({{120, 3}, {40, 5}}, 100);
+        std::cout << "Erro: a entrada deveria ser rejeitada" << std::endl;
+    } catch (const std::invalid_argument& error) {
+        std::cout << "Rejeitada: " << error.what() << std::endl; // Esperado
+    }
+    std::cout << "---" << std::endl;
+
+    return 0;
+}
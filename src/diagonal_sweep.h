@@ -0,0 +1,104 @@
+#ifndef DIAGONAL_SWEEP_H
+#define DIAGONAL_SWEEP_H
+
+#include <vector>
+#include <algorithm>          // Para std::max, std::min
+#include <atomic>             // Para o contador de blocos de cada diagonal
+#include <thread>
+#include <mutex>
+#include <condition_variable> // Para a barreira entre diagonais
+
+/**
+ * @brief Barreira reutilizável simples (C++17 não tem std::barrier).
+ *
+ * Usada por parallelDiagonals e pela varredura de anti-diagonais do corte
+ * guilhotinado.
+ */
+class Barrier {
+public:
+    explicit Barrier(int count) : count(count), waiting(0), generation(0) {}
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        int my_generation = generation;
+        if (++waiting == count) {
+            waiting = 0;
+            generation++;
+            cv.notify_all();
+        } else {
+            cv.wait(lock, [&] { return generation != my_generation; });
+        }
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable cv;
+    int count, waiting, generation;
+};
+
+// Trabalho mínimo (em passos do laço de dentro) de um bloco de células.
+// Abaixo disso, pegar o bloco custa mais que resolvê-lo.
+const long long MIN_CHUNK_WORK = 4096;
+
+/**
+ * @brief Varre as diagonais de uma DP de intervalo em paralelo.
+ *
+ * As células de comprimento l (i = 1..n-l+1, j = i+l-1) só dependem de
+ * comprimentos menores, então uma diagonal inteira pode ser dividida entre
+ * as threads. Uma barreira separa uma diagonal da próxima. As threads são
+ * criadas uma vez e ficam até o fim.
+ *
+ * Os blocos se adaptam à diagonal. O tamanho é o maior de dois pisos:
+ * MIN_CHUNK_WORK passos, segundo a estimativa cell_work(l), e 1/4 do que cabe
+ * a cada thread (mais blocos que isso só aumentam a disputa pelo contador).
+ * Quando os dois discordam, o piso de trabalho ganha do balanceamento: uma
+ * diagonal barata pode virar menos de 4 blocos por thread, ou um só. As
+ * últimas diagonais são curtas e caras (na DP cúbica) e viram blocos de
+ * poucas células. As threads pegam blocos de um contador atômico.
+ *
+ * Cada célula é calculada pelo mesmo código que na versão serial, então o
+ * resultado é idêntico bit a bit, com qualquer número de threads. Só isso
+ * foi conferido: a máquina de desenvolvimento tem um núcleo, então o ganho
+ * com vários núcleos não foi medido.
+ *
+ * @param n Número de itens (comprimentos vão de first_length a n).
+ * @param first_length Primeiro comprimento a varrer (os menores já são casos base).
+ * @param threads Número de threads (0 = hardware_concurrency).
+ * @param cell_work cell_work(l): passos estimados para uma célula de comprimento l.
+ * @param solve solve(l, i_begin, i_end): resolve as células de comprimento l com i em [i_begin, i_end).
+ */
+template <typename Work, typename Solve>
+void parallelDiagonals(int n, int first_length, int threads, Work cell_work, Solve solve) {
+    if (threads <= 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (threads == 1) {
+        for (int l = first_length; l <= n; ++l) solve(l, 1, n - l + 2);
+        return;
+    }
+
+    // Um contador por diagonal: ninguém precisa zerá-lo entre uma diagonal e outra.
+    std::vector<std::atomic<int>> next_chunk(n + 1);
+    Barrier barrier(threads);
+    auto sweep = [&]() {
+        for (int l = first_length; l <= n; ++l) {
+            int cells = n - l + 1;
+            long long work = std::max(1LL, (long long)cell_work(l));
+            int by_work = (int)std::min<long long>(cells, (MIN_CHUNK_WORK + work - 1) / work);
+            int by_balance = (cells + 4 * threads - 1) / (4 * threads);
+            int chunk = std::max(by_work, by_balance);
+            while (true) {
+                int begin = next_chunk[l].fetch_add(chunk, std::memory_order_relaxed);
+                if (begin >= cells) break;
+                solve(l, 1 + begin, 1 + std::min(cells, begin + chunk));
+            }
+            barrier.wait();
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t) pool.emplace_back(sweep);
+    sweep();
+    for (std::thread& worker : pool) worker.join();
+}
+
+#endif // DIAGONAL_SWEEP_H
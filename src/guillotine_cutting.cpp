@@ -0,0 +1,343 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>          // Para std::max, std::min
+#include <thread>             // Para paralelizar as anti-diagonais
+#include <chrono>             // Para medir o tempo do teste grande
+#include <random>             // Para gerar instâncias grandes
+#include "diagonal_sweep.h"   // Barrier: barreira entre as anti-diagonais
+
+/**
+ * @brief Um tipo de peça retangular (sem rotação), com o valor que ela rende.
+ */
+struct RectPiece {
+    int width;
+    int height;
+    long long value;
+};
+
+/**
+ * @brief Uma peça posicionada na chapa (canto inferior esquerdo em (x, y)).
+ */
+struct Placement {
+    int x, y;
+    int piece; // Índice em 'pieces'
+};
+
+/**
+ * @brief Resultado do corte guilhotinado de uma chapa W x H.
+ */
+struct GuillotinePlan {
+    long long value;                    // Valor máximo
+    std::vector<Placement> placements;  // Peças cortadas
+    int raster_width;                   // Quantos pontos de corte sobraram em cada eixo
+    int raster_height;
+};
+
+/**
+ * @brief Pontos raster de um eixo (Herz / Scheithauer).
+ *
+ * Padrões normais N = combinações de tamanhos de peças que cabem em L
+ * (toda peça pode ser empurrada para baixo/esquerda até encostar em outra).
+ * Os pontos raster são R = { <L - x> : x em N }, onde <y> é o maior elemento
+ * de N que não passa de y. Basta cortar nesses pontos, e toda sub-chapa que
+ * aparece tem tamanho em R, então a tabela só precisa desses índices.
+ *
+ * @param sizes Tamanhos das peças neste eixo.
+ * @param L Tamanho da chapa neste eixo.
+ * @param down Recebe down[y] = índice do maior ponto raster <= y (0 <= y <= L).
+ * @return std::vector<int> Pontos raster em ordem crescente (o primeiro é 0).
+ */
+std::vector<int> rasterPoints(const std::vector<int>& sizes, int L, std::vector<int>& down) {
+
+    // --- Passo 1: Padrões normais (mochila de alcançabilidade) ---
+    std::vector<char> normal(L + 1, 0);
+    normal[0] = 1;
+    for (int y = 1; y <= L; y++) {
+        for (int s : sizes) {
+            if (s <= y && normal[y - s]) {
+                normal[y] = 1;
+                break;
+            }
+        }
+    }
+
+    // floorN[y] = <y>, o maior padrão normal <= y.
+    std::vector<int> floorN(L + 1);
+    for (int y = 0; y <= L; y++) {
+        floorN[y] = normal[y] ? y : floorN[y - 1];
+    }
+
+    // --- Passo 2: R = { <L - x> : x em N } ---
+    std::vector<char> is_raster(L + 1, 0);
+    for (int x = 0; x <= L; x++) {
+        if (normal[x]) is_raster[floorN[L - x]] = 1;
+    }
+    std::vector<int> raster;
+    down.assign(L + 1, 0);
+    for (int y = 0; y <= L; y++) {
+        if (is_raster[y]) raster.push_back(y);
+        down[y] = raster.size() - 1;
+    }
+    return raster;
+}
+
+/**
+ * @brief Corte guilhotinado 2D irrestrito: o cutRod em duas dimensões.
+ *
+ * V(w, h) = max( melhor peça que cabe em w x h,
+ *                max_x V(x, h) + V(w - x, h),     (corte vertical)
+ *                max_y V(w, y) + V(w, h - y) )    (corte horizontal)
+ *
+ * Com os pontos raster, w e h só percorrem R_W e R_H, os cortes x/y só os
+ * pontos raster até a metade (simetria) e a sobra w - x é arredondada para
+ * baixo até o ponto raster anterior. A tabela é um vetor plano
+ * |R_W| x |R_H|. A célula (a, b) depende só de células com a' < a (mesma
+ * linha) ou b' < b (mesma coluna), então toda anti-diagonal a + b = d é
+ * independente e é dividida entre as threads, com uma barreira entre diagonais.
+ *
+ * @param pieces Tipos de peça (cópias ilimitadas, sem rotação).
+ * @param W Largura da chapa.
+ * @param H Altura da chapa.
+ * @param threads Número de threads (0 = hardware_concurrency).
+ * @return GuillotinePlan Valor máximo e as peças posicionadas.
+ */
+GuillotinePlan guillotineCut(const std::vector<RectPiece>& pieces, int W, int H, int threads = 0) {
+
+    GuillotinePlan plan;
+    plan.value = 0;
+
+    std::vector<int> widths, heights;
+    for (const RectPiece& piece : pieces) {
+        if (piece.width <= W && piece.height <= H) {
+            widths.push_back(piece.width);
+            heights.push_back(piece.height);
+        }
+    }
+    std::vector<int> downW, downH;
+    std::vector<int> RW = rasterPoints(widths, W, downW);
+    std::vector<int> RH = rasterPoints(heights, H, downH);
+    int nw = RW.size(), nh = RH.size();
+    plan.raster_width = nw;
+    plan.raster_height = nh;
+
+    // Tabelas planas: célula (a, b) = chapa RW[a] x RH[b] em a * nh + b.
+    // decision < 0: peça -(decision + 1); 0: vazia; 2k: corte vertical em RW[k];
+    // 2k + 1: corte horizontal em RH[k].
+    std::vector<long long> V((size_t)nw * nh, 0);
+    std::vector<int> decision((size_t)nw * nh, 0);
+
+    // --- Passo 1: Melhor peça que cabe em cada célula ---
+    // Marca cada peça no menor ponto raster que a comporta e propaga o
+    // máximo para as chapas maiores (prefixo 2D).
+    for (int i = 0; i < (int)pieces.size(); i++) {
+        const RectPiece& piece = pieces[i];
+        if (piece.width > W || piece.height > H) continue;
+        int a = std::lower_bound(RW.begin(), RW.end(), piece.width) - RW.begin();
+        int b = std::lower_bound(RH.begin(), RH.end(), piece.height) - RH.begin();
+        size_t cell = (size_t)a * nh + b;
+        if (piece.value > V[cell]) {
+            V[cell] = piece.value;
+            decision[cell] = -(i + 1);
+        }
+    }
+    for (int a = 0; a < nw; a++) {
+        for (int b = 0; b < nh; b++) {
+            size_t cell = (size_t)a * nh + b;
+            if (a > 0 && V[cell - nh] > V[cell]) {
+                V[cell] = V[cell - nh];
+                decision[cell] = decision[cell - nh];
+            }
+            if (b > 0 && V[cell - 1] > V[cell]) {
+                V[cell] = V[cell - 1];
+                decision[cell] = decision[cell - 1];
+            }
+        }
+    }
+
+    // --- Passo 2: Cortes, uma anti-diagonal por vez ---
+    auto solveCell = [&](int a, int b) {
+        size_t cell = (size_t)a * nh + b;
+        long long best = V[cell];
+        int best_decision = decision[cell];
+        int w = RW[a], h = RH[b];
+
+        // Corte vertical em x = RW[k] <= w/2; a sobra vai para <w - x>.
+        for (int k = 1; k < nw && 2 * RW[k] <= w; k++) {
+            long long candidate = V[(size_t)k * nh + b] + V[(size_t)downW[w - RW[k]] * nh + b];
+            if (candidate > best) {
+                best = candidate;
+                best_decision = 2 * k;
+            }
+        }
+        // Corte horizontal em y = RH[k] <= h/2.
+        const long long* row = &V[(size_t)a * nh];
+        for (int k = 1; k < nh && 2 * RH[k] <= h; k++) {
+            long long candidate = row[k] + row[downH[h - RH[k]]];
+            if (candidate > best) {
+                best = candidate;
+                best_decision = 2 * k + 1;
+            }
+        }
+        V[cell] = best;
+        decision[cell] = best_decision;
+    };
+
+    if (threads <= 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    int diagonals = nw + nh - 1;
+    auto sweep = [&](int id, int count, Barrier* barrier) {
+        for (int d = 0; d < diagonals; d++) {
+            int a_lo = std::max(0, d - (nh - 1));
+            int a_hi = std::min(nw - 1, d);
+            int len = a_hi - a_lo + 1;
+            // Fatia contígua da diagonal para esta thread.
+            int begin = a_lo + (long long)len * id / count;
+            int end = a_lo + (long long)len * (id + 1) / count;
+            for (int a = begin; a < end; a++) {
+                solveCell(a, d - a);
+            }
+            if (barrier) barrier->wait();
+        }
+    };
+    // Tabelas pequenas não compensam a sincronização.
+    if (threads == 1 || (size_t)nw * nh < 4096) {
+        sweep(0, 1, nullptr);
+    } else {
+        Barrier barrier(threads);
+        std::vector<std::thread> pool;
+        for (int t = 1; t < threads; t++) {
+            pool.emplace_back(sweep, t, threads, &barrier);
+        }
+        sweep(0, threads, &barrier);
+        for (std::thread& worker : pool) worker.join();
+    }
+
+    // --- Passo 3: Reconstrução com pilha explícita ---
+    struct Plate { int x, y, a, b; };
+    std::vector<Plate> stack = {{0, 0, nw - 1, nh - 1}};
+    plan.value = V[(size_t)(nw - 1) * nh + (nh - 1)];
+    while (!stack.empty()) {
+        Plate plate = stack.back();
+        stack.pop_back();
+        int code = decision[(size_t)plate.a * nh + plate.b];
+        if (code < 0) {
+            plan.placements.push_back({plate.x, plate.y, -code - 1});
+        } else if (code > 0 && code % 2 == 0) {
+            int k = code / 2;
+            stack.push_back({plate.x, plate.y, k, plate.b});
+            stack.push_back({plate.x + RW[k], plate.y, downW[RW[plate.a] - RW[k]], plate.b});
+        } else if (code > 0) {
+            int k = code / 2;
+            stack.push_back({plate.x, plate.y, plate.a, k});
+            stack.push_back({plate.x, plate.y + RH[k], plate.a, downH[RH[plate.b] - RH[k]]});
+        }
+    }
+    return plan;
+}
+
+/**
+ * @brief DP direta em todos os inteiros (sem pontos raster), para conferência.
+ */
+long long guillotineCutNaive(const std::vector<RectPiece>& pieces, int W, int H) {
+    std::vector<std::vector<long long>> V(W + 1, std::vector<long long>(H + 1, 0));
+    for (int w = 1; w <= W; w++) {
+        for (int h = 1; h <= H; h++) {
+            long long best = 0;
+            for (const RectPiece& piece : pieces) {
+                if (piece.width <= w && piece.height <= h) best = std::max(best, piece.value);
+            }
+            for (int x = 1; x < w; x++) best = std::max(best, V[x][h] + V[w - x][h]);
+            for (int y = 1; y < h; y++) best = std::max(best, V[w][y] + V[w][h - y]);
+            V[w][h] = best;
+        }
+    }
+    return V[W][H];
+}
+
+/**
+ * @brief Confere se as peças do plano estão dentro da chapa, sem sobreposição,
+ * e se somam o valor informado.
+ */
+bool checkPlan(const GuillotinePlan& plan, const std::vector<RectPiece>& pieces, int W, int H) {
+    long long total = 0;
+    const std::vector<Placement>& P = plan.placements;
+    for (size_t i = 0; i < P.size(); i++) {
+        const RectPiece& pi = pieces[P[i].piece];
+        if (P[i].x < 0 || P[i].y < 0 || P[i].x + pi.width > W || P[i].y + pi.height > H) return false;
+        for (size_t j = i + 1; j < P.size(); j++) {
+            const RectPiece& pj = pieces[P[j].piece];
+            bool apart = P[i].x + pi.width <= P[j].x || P[j].x + pj.width <= P[i].x ||
+                         P[i].y + pi.height <= P[j].y || P[j].y + pj.height <= P[i].y;
+            if (!apart) return false;
+        }
+        total += pi.value;
+    }
+    return total == plan.value;
+}
+
+// Main para teste
+int main(int argc, char* argv[]) {
+    std::cout << "---" << std::endl;
+    std::cout << "Algoritmo: Corte Guilhotinado 2D (cutRod em duas dimensoes)" << std::endl;
+    std::cout << "Pontos raster + tabela plana + anti-diagonais em paralelo" << std::endl;
+    std::cout << "---" << std::endl;
+
+    // --- Teste 1: Chapa pequena ---
+    std::vector<RectPiece> pieces1 = {{3, 2, 7}, {2, 4, 9}, {5, 3, 17}, {1, 1, 1}};
+    int W1 = 10, H1 = 7;
+    GuillotinePlan plan1 = guillotineCut(pieces1, W1, H1);
+    std::cout << "--- Teste 1: Chapa " << W1 << " x " << H1 << " ---" << std::endl;
+    std::cout << "Valor maximo: " << plan1.value << std::endl;
+    std::cout << "Conferencia (DP completa): " << guillotineCutNaive(pieces1, W1, H1) << std::endl;
+    std::cout << "Pecas cortadas:" << std::endl;
+    for (const Placement& p : plan1.placements) {
+        std::cout << "\t" << pieces1[p.piece].width << " x " << pieces1[p.piece].height
+                  << " em (" << p.x << ", " << p.y << ")" << std::endl;
+    }
+    std::cout << "Plano valido: " << (checkPlan(plan1, pieces1, W1, H1) ? "sim" : "NAO") << std::endl;
+    std::cout << "---" << std::endl;
+
+    // --- Teste 2: Instâncias aleatórias contra a DP completa ---
+    std::cout << "--- Teste 2: Raster vs DP completa (instancias aleatorias) ---" << std::endl;
+    std::mt19937 rng(7);
+    int mismatches = 0;
+    for (int trial = 0; trial < 100; trial++) {
+        int W = 5 + rng() % 30, H = 5 + rng() % 30;
+        std::vector<RectPiece> pieces(1 + rng() % 5);
+        for (RectPiece& piece : pieces) {
+            piece.width = 2 + rng() % 12;
+            piece.height = 2 + rng() % 12;
+            piece.value = 1 + rng() % (piece.width * piece.height * 2);
+        }
+        GuillotinePlan plan = guillotineCut(pieces, W, H, 1 + trial % 3);
+        if (plan.value != guillotineCutNaive(pieces, W, H) || !checkPlan(plan, pieces, W, H)) {
+            mismatches++;
+        }
+    }
+    std::cout << "Divergencias: " << mismatches << " (esperado 0)" << std::endl;
+    std::cout << "---" << std::endl;
+
+    // --- Teste 3: Chapa grande ---
+    // Com "--bench", 10^4 x 10^4.
+    bool bench = argc > 1 && std::string(argv[1]) == "--bench";
+    int W3 = bench ? 10000 : 3000, H3 = W3;
+    std::vector<RectPiece> pieces3(20);
+    for (RectPiece& piece : pieces3) {
+        piece.width = W3 / 20 + rng() % (W3 / 4);
+        piece.height = H3 / 20 + rng() % (H3 / 4);
+        piece.value = (long long)piece.width * piece.height / 100 + rng() % 1000;
+    }
+    auto start = std::chrono::steady_clock::now();
+    GuillotinePlan plan3 = guillotineCut(pieces3, W3, H3);
+    auto end = std::chrono::steady_clock::now();
+    std::cout << "--- Teste 3: Chapa " << W3 << " x " << H3 << ", 20 tipos ---" << std::endl;
+    std::cout << "Pontos raster: " << plan3.raster_width << " x " << plan3.raster_height << std::endl;
+    std::cout << "Valor maximo: " << plan3.value << " com " << plan3.placements.size() << " pecas" << std::endl;
+    std::cout << "Plano valido: " << (checkPlan(plan3, pieces3, W3, H3) ? "sim" : "NAO") << std::endl;
+    std::cout << "Tempo: " << std::chrono::duration<double>(end - start).count() << " s" << std::endl;
+    std::cout << "---" << std::endl;
+
+    return 0;
+}
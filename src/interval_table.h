@@ -0,0 +1,76 @@
+#ifndef INTERVAL_TABLE_H
+#define INTERVAL_TABLE_H
+
+#include <vector>
+#include <cstddef> // Para size_t
+
+/**
+ * @brief Tabela triangular compacta para DPs de intervalo (árvore ótima, cadeia de matrizes).
+ *
+ * Guarda só as células [i, j] com 1 <= i <= n + 1 e i - 1 <= j <= n, isto é,
+ * os comprimentos l = j - i + 1 de 0 a n. Há n + 1 - l células de cada
+ * comprimento, (n + 1)(n + 2) / 2 no total, contra (n + 2)^2 da tabela
+ * quadrada.
+ *
+ * O layout é por diagonal: as células de comprimento l ficam contíguas, em
+ * ordem crescente de i. O laço "para cada l, para cada i" das DPs de
+ * intervalo escreve em sequência. As leituras (i, r - 1) e (r + 1, j) andam
+ * uma posição por i dentro de cada diagonal, então também seguem em fluxo.
+ *
+ * table[i][j] funciona como na tabela aninhada (std::vector de std::vector),
+ * para os algoritmos valerem com os dois formatos.
+ */
+template <typename T>
+struct TriangularTable {
+    int n = 0;
+    std::vector<size_t> diagonal_start; // diagonal_start[l] = posição da célula (1, l)
+    std::vector<T> data;
+
+    TriangularTable() = default;
+    explicit TriangularTable(int n, T value = T()) { assign(n, value); }
+
+    void assign(int size, T value = T()) {
+        n = size;
+        diagonal_start.assign(n + 2, 0);
+        for (int l = 1; l <= n + 1; ++l) diagonal_start[l] = diagonal_start[l - 1] + (n + 2 - l);
+        data.assign(diagonal_start[n + 1], value);
+    }
+
+    size_t index(int i, int j) const { return diagonal_start[j - i + 1] + (i - 1); }
+    T& at(int i, int j) { return data[index(i, j)]; }
+    const T& at(int i, int j) const { return data[index(i, j)]; }
+
+    // Diagonal l inteira: diagonal(l)[i - 1] é a célula (i, i + l - 1).
+    T* diagonal(int l) { return data.data() + diagonal_start[l]; }
+    const T* diagonal(int l) const { return data.data() + diagonal_start[l]; }
+
+    size_t bytes() const { return data.size() * sizeof(T); }
+
+    struct Row {
+        TriangularTable* table;
+        int i;
+        T& operator[](int j) const { return table->at(i, j); }
+    };
+    struct ConstRow {
+        const TriangularTable* table;
+        int i;
+        const T& operator[](int j) const { return table->at(i, j); }
+    };
+    Row operator[](int i) { return {this, i}; }
+    ConstRow operator[](int i) const { return {this, i}; }
+};
+
+/**
+ * @brief Dimensiona uma tabela de intervalo para n itens (formato aninhado ou compacto).
+ */
+template <typename T>
+void resizeIntervalTable(std::vector<std::vector<T>>& table, int n) {
+    table.assign(n + 2, std::vector<T>(n + 2));
+}
+
+template <typename T>
+void resizeIntervalTable(TriangularTable<T>& table, int n) {
+    table.assign(n);
+}
+
+#endif // INTERVAL_TABLE_H
@@ -1,20 +1,42 @@
 #include <iostream>
 #include <vector>
 #include <climits> // Para INT_MAX (infinito)
+#include <limits>  // Para o infinito em double do planejador por caminho crítico
+#include <algorithm> // Para std::min, std::fill
+#include <string>
+#include <random>  // Para as cadeias grandes da comparação de layouts
+#include <chrono>
+#include <thread>  // Para o GEMM com várias threads
+#include <cmath>   // Para std::abs na conferência do executor
+#include <cstring> // Para std::memcpy nos vetores SIMD
+#include <deque>   // Filas de tarefas do escalonador com roubo de trabalho
+#include <mutex>
+#include <condition_variable> // Threads ociosas dormem até haver tarefa
+#include <atomic>
+#include <cstdint> // Para o produto de 128 bits do teste de Chin
+#include "interval_table.h" // TriangularTable: tabelas [i, j] compactas, por diagonal
+#include "perf_counter.h"   // Faltas de cache na comparação de layouts
+#include "diagonal_sweep.h" // parallelDiagonals: diagonais divididas entre threads
 
 /**
  * @brief Soluciona o Problema da Multiplicação de Cadeias de Matrizes 
  * usando programação dinâmica (abordagem bottom-up).
  *
+ * Versão de referência, na ordem de laços do livro (k no laço de dentro).
+ * Vale com a tabela aninhada original ou com a TriangularTable
+ * (interval_table.h); matrixChainOrder é a versão usada no programa.
+ *
  * @param p Um vetor de dimensões. Se temos N matrizes (A1, A2, ..., AN),
  * o vetor 'p' terá N+1 elementos.
  * A matriz Ai tem dimensões p[i-1] x p[i].
  *
  * Ex: p = {10, 20, 30} -> A1 é (10x20), A2 é (20x30).
+ * @param m_table Tabela de custos (saída).
  *
  * @return int O número mínimo de multiplicações escalares necessárias.
  */
-int matrixChainOrder(const std::vector<int>& p) {
+template <typename Table>
+int matrixChainCost(const std::vector<int>& p, Table& m_table) {
     
     // Se p.size() for 1 ou 0, não há matrizes (ou só 1 dimensão),
     // então o custo é 0. (p.size() precisa ser pelo menos 2 para 1 matriz).
@@ -29,9 +51,8 @@ int matrixChainOrder(const std::vector<int>& p) {
 
     // Tabela de DP. m_table[i][j] vai guardar o custo mínimo
     // para multiplicar a cadeia de matrizes de Ai até Aj.
-    // Usamos (n+1) x (n+1) para usar índices 1-based (de 1 a n),
-    // que facilita a tradução do pseudo-algoritmo do Cormen.
-    std::vector<std::vector<int>> m_table(n + 1, std::vector<int>(n + 1));
+    // Os índices são 1-based (de 1 a n), como no pseudo-algoritmo do Cormen.
+    resizeIntervalTable(m_table, n);
 
     // --- Passo 1: Casos Base ---
     // O custo para "multiplicar" uma cadeia de comprimento 1 (uma única matriz) é 0.
@@ -85,8 +106,1282 @@ int matrixChainOrder(const std::vector<int>& p) {
     return m_table[1][n];
 }
 
+/**
+ * @brief Custo mínimo da cadeia, com a tabela triangular compacta e laços em fluxo.
+ * (Mesmos parâmetros e retorno de matrixChainCost)
+ *
+ * Na TriangularTable cada comprimento L é uma diagonal contígua. Com k no laço
+ * de dentro, m[i][k] e m[k+1][j] pulam de diagonal a cada passo. Por isso os
+ * laços são trocados: para cada deslocamento d = k - i, o laço em i lê
+ * m[i][i+d] (diagonal d+1) e m[i+d+1][j] (diagonal L-1-d) em sequência, e
+ * atualiza o mínimo da diagonal L também em sequência. O compilador
+ * consegue vetorizar esse laço.
+ *
+ * Com threads != 1, cada diagonal é dividida em blocos de i entre as threads
+ * (parallelDiagonals, diagonal_sweep.h). Dentro de um bloco os laços são
+ * os mesmos, então a tabela sai idêntica à serial.
+ *
+ * A tabela s guarda a divisão ótima: s[i][j] = k quer dizer
+ * (Ai...Ak) * (Ak+1...Aj). Como d cresce, o primeiro k de custo mínimo é
+ * mantido, igual ao laço do livro.
+ *
+ * @param p Vetor de dimensões (como em matrixChainCost).
+ * @param m_table Tabela de custos (saída).
+ * @param s_table Tabela de divisões, int32 compacta (saída).
+ * @param threads Número de threads (1 = serial, 0 = hardware_concurrency).
+ * @return int O número mínimo de multiplicações escalares necessárias.
+ */
+int matrixChainTable(const std::vector<int>& p, TriangularTable<int>& m_table,
+                     TriangularTable<int>& s_table, int threads = 1) {
+    if (p.size() < 2) {
+        return 0;
+    }
+    int n = p.size() - 1;
+
+    // --- Passo 1: Casos Base ---
+    // A diagonal L = 1 (m[i][i]) já começa com 0.
+    m_table.assign(n);
+    s_table.assign(n);
+
+    // --- Passo 2: Diagonais L = 2..n ---
+    // Posição x = i - 1 na diagonal: diagonal(L)[x] é m[i][i+L-1].
+    // solveCells resolve as posições de i_begin - 1 a i_end - 2 da diagonal L.
+    auto solveCells = [&](int L, int i_begin, int i_end) {
+        int x_begin = i_begin - 1, x_end = i_end - 1;
+        int* best = m_table.diagonal(L);
+        int* split = s_table.diagonal(L);
+        std::fill(best + x_begin, best + x_end, INT_MAX);
+        for (int d = 0; d <= L - 2; d++) {
+            const int* left = m_table.diagonal(d + 1);          // m[i][k], k = i + d
+            const int* right = m_table.diagonal(L - 1 - d) + d + 1; // m[k+1][j]
+            const int* pk = p.data() + d + 1;                   // p[k]
+            const int* pj = p.data() + L;                       // p[j]
+            for (int x = x_begin; x < x_end; x++) {
+                int cost = left[x] + right[x] + p[x] * pk[x] * pj[x];
+                if (cost < best[x]) {
+                    best[x] = cost;
+                    split[x] = x + 1 + d; // k = i + d
+                }
+            }
+        }
+    };
+    // Uma célula de comprimento L testa L - 1 divisões.
+    parallelDiagonals(n, 2, threads, [](int L) { return L - 1; }, solveCells);
+    return m_table[1][n];
+}
+
+/**
+ * @brief Custo mínimo da cadeia e a tabela de divisões (versão usada no programa).
+ * (Mesmos parâmetros e retorno de matrixChainTable)
+ */
+int matrixChainOrder(const std::vector<int>& p, TriangularTable<int>& s_table, int threads = 1) {
+    TriangularTable<int> m_table;
+    return matrixChainTable(p, m_table, s_table, threads);
+}
+
+/**
+ * @brief Só o custo mínimo da cadeia.
+ */
+int matrixChainOrder(const std::vector<int>& p, int threads = 1) {
+    TriangularTable<int> s_table;
+    return matrixChainOrder(p, s_table, threads);
+}
+
+/**
+ * @brief Parentização ótima, como o PRINT-OPTIMAL-PARENS do Cormen, mas sem recursão.
+ *
+ * A pilha guarda intervalos a abrir e marcadores de ")" a fechar, na ordem
+ * em que a recursão do livro os escreveria.
+ *
+ * @param s_table Tabela de divisões de matrixChainOrder.
+ * @param n Número de matrizes.
+ * @return std::string Ex.: "((A1(A2A3))((A4A5)A6))".
+ */
+std::string optimalParens(const TriangularTable<int>& s_table, int n) {
+    struct Item { int i, j; }; // i == 0: marcador de ")"
+    std::vector<Item> stack = {{1, n}};
+    std::string text;
+    while (!stack.empty()) {
+        Item item = stack.back();
+        stack.pop_back();
+        if (item.i == 0) {
+            text += ')';
+        } else if (item.i == item.j) {
+            text += 'A';
+            text += std::to_string(item.i);
+        } else {
+            int k = s_table[item.i][item.j];
+            text += '(';
+            stack.push_back({0, 0});
+            stack.push_back({k + 1, item.j});
+            stack.push_back({item.i, k});
+        }
+    }
+    return text;
+}
+
+/**
+ * @brief Um passo do plano de execução: result = left * right.
+ *
+ * Operandos 0..n-1 são as matrizes de entrada A1..An; o passo t do plano
+ * produz o operando n + t.
+ */
+struct MultiplyStep {
+    int result;
+    int left, right;
+    int rows, inner, cols; // left é rows x inner, right é inner x cols
+};
+
+/**
+ * @brief Plano em pós-ordem: cada passo só usa operandos de entrada ou de passos anteriores.
+ *
+ * Percorre a árvore de divisões com uma pilha explícita. Cada intervalo é
+ * visitado duas vezes: na primeira empilha os dois lados, na segunda emite
+ * a multiplicação (com o k guardado na pilha: split é chamada uma vez por
+ * intervalo, em pré-ordem). Os ids dos resultados ficam numa segunda pilha, como na
+ * avaliação de uma expressão pós-fixa.
+ *
+ * A divisão vem de uma função, para servir também a quem não tem a tabela
+ * s inteira (huShingOrder, com n grande demais para O(n^2) de memória).
+ *
+ * @param split split(i, j): o k ótimo de (Ai...Aj), i < j.
+ * @param p Vetor de dimensões.
+ * @return std::vector<MultiplyStep> n - 1 passos; o último produz A1...An.
+ */
+template <typename Split>
+std::vector<MultiplyStep> multiplyPlanFrom(Split split, const std::vector<int>& p) {
+    int n = p.size() - 1;
+    std::vector<MultiplyStep> plan;
+    if (n < 2) return plan;
+    plan.reserve(n - 1);
+
+    struct Visit { int i, j, k; bool expanded; };
+    std::vector<Visit> stack = {{1, n, 0, false}};
+    std::vector<int> operands; // Ids já prontos, da esquerda para a direita
+    while (!stack.empty()) {
+        Visit visit = stack.back();
+        stack.pop_back();
+        if (visit.i == visit.j) {
+            operands.push_back(visit.i - 1);
+        } else if (!visit.expanded) {
+            int k = split(visit.i, visit.j);
+            stack.push_back({visit.i, visit.j, k, true});
+            stack.push_back({k + 1, visit.j, 0, false});
+            stack.push_back({visit.i, k, 0, false});
+        } else {
+            int k = visit.k;
+            int right = operands.back();
+            operands.pop_back();
+            int left = operands.back();
+            operands.pop_back();
+            int result = n + (int)plan.size();
+            plan.push_back({result, left, right, p[visit.i - 1], p[k], p[visit.j]});
+            operands.push_back(result);
+        }
+    }
+    return plan;
+}
+
+/**
+ * @brief Plano a partir da tabela de divisões de matrixChainOrder (veja multiplyPlanFrom).
+ */
+std::vector<MultiplyStep> multiplyPlan(const TriangularTable<int>& s_table, const std::vector<int>& p) {
+    return multiplyPlanFrom([&](int i, int j) { return s_table[i][j]; }, p);
+}
+
+/**
+ * @brief Plano a partir de uma triangulação do polígono da cadeia.
+ *
+ * O triângulo sobre o lado (i-1, j) tem como terceiro vértice o k da
+ * divisão de (Ai...Aj): o maior vizinho de i-1 antes de j (o lado até i
+ * conta). Basta guardar, para cada u, as pontas maiores das diagonais que
+ * saem dele, em ordem: duas passadas de counting sort montam essas listas
+ * num vetor só (CSR), em O(n).
+ *
+ * A consulta também é O(1), sem busca: na pré-ordem de multiplyPlanFrom,
+ * os lados (u, v) consultados para um mesmo u descem pela lista de u. O
+ * primeiro é (0, n) ou (k, v) com v a maior ponta de k (diagonais de k
+ * além de v cruzariam (u, v)); cada próximo é (u, k) com o k que acabou de
+ * sair. Um cursor por u, que só anda para trás, dá todas as respostas.
+ *
+ * @param p Vetor de dimensões.
+ * @param diagonals Diagonais da triangulação, em índices de vértice 0..n (repetidas são ignoradas).
+ * @param plan Plano (saída).
+ * @return long long Custo do plano, em inteiros.
+ */
+long long planFromTriangulation(const std::vector<int>& p, const std::vector<std::pair<int, int>>& diagonals,
+                                std::vector<MultiplyStep>& plan) {
+    int vertices = p.size();
+    std::vector<std::pair<int, int>> by_high(diagonals.size());
+    std::vector<int> count(vertices + 1, 0), higher(diagonals.size());
+    // Passada 1: ordena por ponta maior.
+    for (const auto& d : diagonals) count[std::max(d.first, d.second) + 1]++;
+    for (int v = 0; v < vertices; v++) count[v + 1] += count[v];
+    for (const auto& d : diagonals) {
+        by_high[count[std::max(d.first, d.second)]++] = {std::min(d.first, d.second), std::max(d.first, d.second)};
+    }
+    // Passada 2: distribui pela ponta menor, estável, então cada lista sai em ordem.
+    std::vector<int> first(vertices + 1, 0);
+    for (const auto& d : by_high) first[d.first + 1]++;
+    for (int v = 0; v < vertices; v++) first[v + 1] += first[v];
+    std::vector<int> fill(first.begin(), first.end() - 1);
+    for (const auto& d : by_high) higher[fill[d.first]++] = d.second;
+
+    // Tira repetidas (huShingOrder pode gerar a mesma diagonal pelos dois lados).
+    // cursor[u]: fim da parte da lista de u ainda não consultada.
+    std::vector<int> cursor(vertices);
+    for (int u = 0; u < vertices; u++) {
+        int end = first[u];
+        for (int x = first[u]; x < first[u + 1]; x++) {
+            if (end == first[u] || higher[end - 1] != higher[x]) higher[end++] = higher[x];
+        }
+        cursor[u] = end;
+    }
+    plan = multiplyPlanFrom([&](int i, int j) {
+        int u = i - 1;
+        int& top = cursor[u];
+        if (top > first[u] && higher[top - 1] == j) top--; // j já foi a resposta anterior
+        return top > first[u] ? higher[top - 1] : i;
+    }, p);
+    long long total = 0;
+    for (const MultiplyStep& step : plan) total += (long long)step.rows * step.inner * step.cols;
+    return total;
+}
+
+/**
+ * @brief Heap esquerdista de máximo, com os pontos de quebra das envelopes de huShingOrder.
+ *
+ * Todos os nós ficam num vetor só; um heap é o índice da sua raiz (-1 = vazio).
+ * merge é O(log n), o que deixa a junção das subárvores em O(n log n) no total.
+ */
+struct BreakpointHeap {
+    struct Node {
+        long double x, delta; // Em x, a inclinação cai delta
+        int left, right, rank;
+    };
+    std::vector<Node> nodes;
+
+    int make(long double x, long double delta) {
+        nodes.push_back({x, delta, -1, -1, 1});
+        return nodes.size() - 1;
+    }
+    int rank(int h) const { return h < 0 ? 0 : nodes[h].rank; }
+    int merge(int a, int b) {
+        if (a < 0) return b;
+        if (b < 0) return a;
+        if (nodes[a].x < nodes[b].x) std::swap(a, b);
+        nodes[a].right = merge(nodes[a].right, b);
+        if (rank(nodes[a].left) < rank(nodes[a].right)) std::swap(nodes[a].left, nodes[a].right);
+        nodes[a].rank = rank(nodes[a].right) + 1;
+        return a;
+    }
+    int pop(int h) { return merge(nodes[h].left, nodes[h].right); }
+};
+
+/**
+ * @brief Função côncava, linear por partes: F(x) = value0 + slope0 x - soma de delta_i (x - x_i) para x_i < x.
+ */
+struct Envelope {
+    int heap = -1;
+    long double value0 = 0, slope0 = 0;
+    long double delta_sum = 0, delta_x_sum = 0; // Somas de delta_i e de delta_i x_i no heap
+
+    void add(const Envelope& other, BreakpointHeap& heaps) {
+        heap = heaps.merge(heap, other.heap);
+        value0 += other.value0;
+        slope0 += other.slope0;
+        delta_sum += other.delta_sum;
+        delta_x_sum += other.delta_x_sum;
+    }
+    void popTop(BreakpointHeap& heaps) {
+        delta_sum -= heaps.nodes[heap].delta;
+        delta_x_sum -= heaps.nodes[heap].delta * heaps.nodes[heap].x;
+        heap = heaps.pop(heap);
+    }
+    // Descarta os pontos de quebra acima de x_max: ninguém avalia F depois deles.
+    void truncate(long double x_max, BreakpointHeap& heaps) {
+        while (heap >= 0 && heaps.nodes[heap].x > x_max) popTop(heaps);
+    }
+    // Vale para x >= todos os pontos de quebra (use truncate antes).
+    long double valueAfterBreakpoints(long double x) const {
+        return value0 + (slope0 - delta_sum) * x + delta_x_sum;
+    }
+};
+
+/**
+ * @brief Ordem ótima da cadeia em O(n log n), pela partição de polígono de Hu e Shing.
+ *
+ * A cadeia com dimensões p[0..n] é um polígono convexo de n + 1 vértices
+ * com pesos p; cada triangulação é uma parentização e custa a soma, sobre
+ * os triângulos, do produto dos três pesos. Girando o polígono para o
+ * vértice de menor peso V0 ficar na posição 0 (empates desfeitos pelo
+ * índice):
+ *
+ * - Um "h-arco potencial" é uma diagonal (a, b) cujos vértices entre a e b
+ *   (do lado sem V0) pesam mais que a e b. Uma varredura com pilha acha
+ *   todos em O(n). Eles não se cruzam e formam uma árvore, com o polígono
+ *   inteiro, (0, n + 1), como raiz.
+ * - Hu e Shing mostram que existe uma partição ótima formada por alguns
+ *   desses arcos e, entre eles, leques (fans) saindo do vértice mais leve
+ *   de cada região. Sobra escolher quais arcos entram.
+ * - F_h(x) é o custo da parte acima de h quando h está na região de um
+ *   leque de vértice de peso x (de fora de h):
+ *     F_h(x) = min(C_h + x w_a w_b, x S_h + soma dos F_filho(x)),
+ *   com h presente (C_h: custo ótimo do subpolígono de h) ou ausente (o
+ *   leque de fora cobre os lados S_h da região de h e desce aos filhos).
+ *   F é côncava e a segunda opção tem sempre inclinação maior, então há um
+ *   único ponto de troca x*_h (o "peso de suporte" de h). Cada F guarda
+ *   seus pontos de quebra num heap esquerdista; somar filhos é juntar
+ *   heaps, e o min com a reta tira pontos do topo. Cada ponto entra e sai
+ *   no máximo uma vez: O(n log n).
+ * - De cima para baixo, h fica se x >= x*_h, e os leques viram diagonais.
+ *
+ * As envelopes usam long double; o custo devolvido é recalculado em
+ * inteiros a partir do plano.
+ *
+ * @param p Vetor de dimensões (como em matrixChainCost).
+ * @param plan Plano de multiplicações (saída), no formato de multiplyPlan.
+ * @return long long Custo do plano (o mínimo de multiplicações escalares).
+ */
+long long huShingOrder(const std::vector<int>& p, std::vector<MultiplyStep>& plan) {
+    plan.clear();
+    int n = (int)p.size() - 1;
+    if (n < 2) return 0;
+
+    // --- Passo 1: Polígono girado, V0 = vértice mais leve ---
+    int N = n + 1; // Vértices; a posição N é de novo V0
+    int shift = std::min_element(p.begin(), p.end()) - p.begin();
+    std::vector<long long> w(N + 1);
+    for (int v = 0; v <= N; v++) w[v] = p[(v + shift) % N];
+    auto lighter = [&](int u, int v) { return w[u] < w[v] || (w[u] == w[v] && u < v); };
+
+    // --- Passo 2: h-arcos potenciais, numa varredura com pilha ---
+    struct Arc { int a, b; };
+    std::vector<Arc> arcs = {{0, N}}; // A raiz: o polígono inteiro
+    std::vector<int> stack = {0};
+    for (int c = 1; c <= N; c++) {
+        while (stack.size() >= 2 && (c == N || lighter(c, stack.back()))) {
+            stack.pop_back();
+            if (!(c == N && stack.back() == 0)) arcs.push_back({stack.back(), c});
+        }
+        stack.push_back(c);
+    }
+
+    // --- Passo 3: Árvore dos arcos (intervalos aninhados) ---
+    std::sort(arcs.begin() + 1, arcs.end(), [](const Arc& x, const Arc& y) {
+        return x.a != y.a ? x.a < y.a : x.b > y.b;
+    });
+    int arc_count = arcs.size();
+    std::vector<std::vector<int>> children(arc_count);
+    std::vector<int> open = {0};
+    for (int h = 1; h < arc_count; h++) {
+        while (arcs[open.back()].b < arcs[h].b) open.pop_back();
+        children[open.back()].push_back(h);
+        open.push_back(h);
+    }
+    // Lados (t, t+1) da região de h: de a até b, pulando o interior dos filhos.
+    auto forEachSide = [&](int h, auto&& visit) {
+        int v = arcs[h].a;
+        for (int c : children[h]) {
+            for (; v < arcs[c].a; v++) visit(v);
+            v = arcs[c].b;
+        }
+        for (; v < arcs[h].b; v++) visit(v);
+    };
+
+    // --- Passo 4: Envelopes de baixo para cima (filhos vêm depois do pai na ordem) ---
+    BreakpointHeap heaps;
+    heaps.nodes.reserve(2 * arc_count);
+    std::vector<Envelope> envelope(arc_count);
+    std::vector<long double> subpolygon_cost(arc_count), support(arc_count);
+    for (int h = arc_count - 1; h >= 0; h--) {
+        int a = arcs[h].a, b = arcs[h].b;
+        int apex = h == 0 ? 0 : (lighter(a, b) ? a : b);
+        long double apex_weight = w[apex];
+        auto touchesApex = [&](int v) { return v == apex || (h == 0 && v == N); };
+
+        // C_h: região de h em leque a partir do vértice mais leve de h.
+        long double cost = 0, side_sum = 0;
+        forEachSide(h, [&](int v) {
+            long double product = (long double)w[v] * w[v + 1];
+            side_sum += product;
+            if (!touchesApex(v) && !touchesApex(v + 1)) cost += apex_weight * product;
+        });
+        Envelope below;
+        for (int c : children[h]) {
+            envelope[c].truncate(apex_weight, heaps);
+            if (touchesApex(arcs[c].a) || touchesApex(arcs[c].b)) {
+                // Filho que sai do próprio vértice do leque: fica inteiro.
+                cost += subpolygon_cost[c] - envelope[c].valueAfterBreakpoints(apex_weight);
+            }
+            below.add(envelope[c], heaps);
+        }
+        cost += below.valueAfterBreakpoints(apex_weight);
+        subpolygon_cost[h] = cost;
+        if (h == 0) break;
+
+        // F_h = min(reta de h presente, leque de fora + filhos).
+        below.slope0 += side_sum;
+        long double line_slope = (long double)w[a] * w[b];
+        for (;;) {
+            long double slope_end = below.slope0 - below.delta_sum;
+            long double intercept_end = below.value0 + below.delta_x_sum;
+            if (below.heap >= 0) {
+                long double x_top = heaps.nodes[below.heap].x;
+                if (intercept_end + slope_end * x_top > cost + line_slope * x_top) {
+                    below.popTop(heaps);
+                    continue;
+                }
+            }
+            if (slope_end > line_slope) {
+                long double cross = (cost - intercept_end) / (slope_end - line_slope);
+                long double delta = slope_end - line_slope;
+                below.heap = heaps.merge(below.heap, heaps.make(cross, delta));
+                below.delta_sum += delta;
+                below.delta_x_sum += delta * cross;
+                support[h] = cross;
+            } else {
+                support[h] = std::numeric_limits<long double>::infinity();
+            }
+            break;
+        }
+        envelope[h] = below;
+    }
+
+    // --- Passo 5: Arcos escolhidos e leques, de cima para baixo ---
+    // Diagonais em índices originais.
+    std::vector<std::pair<int, int>> diagonals;
+    diagonals.reserve(n - 2);
+    auto addEdge = [&](int u, int v) { diagonals.push_back({(u + shift) % N, (v + shift) % N}); };
+    std::vector<int> present = {0}, chain;
+    while (!present.empty()) {
+        int h = present.back();
+        present.pop_back();
+        int a = arcs[h].a, b = arcs[h].b;
+        int apex = h == 0 ? 0 : (lighter(a, b) ? a : b);
+        if (h != 0) addEdge(a, b);
+        // Fronteira da região: desce nos filhos ausentes.
+        chain.clear();
+        struct Walk { int h, next_child, v; };
+        std::vector<Walk> walk = {{h, 0, a}};
+        chain.push_back(a);
+        while (!walk.empty()) {
+            Walk& top = walk.back();
+            const std::vector<int>& kids = children[top.h];
+            int stop = top.next_child < (int)kids.size() ? arcs[kids[top.next_child]].a : arcs[top.h].b;
+            for (int v = top.v + 1; v <= stop; v++) chain.push_back(v);
+            if (top.next_child == (int)kids.size()) {
+                walk.pop_back();
+                continue;
+            }
+            int c = kids[top.next_child++];
+            top.v = arcs[c].b;
+            bool c_present = arcs[c].a == apex || arcs[c].b == apex || (h == 0 && arcs[c].b == N)
+                             || w[apex] >= support[c];
+            if (c_present) {
+                present.push_back(c);
+                chain.push_back(arcs[c].b);
+            } else {
+                walk.push_back({c, 0, arcs[c].a});
+            }
+        }
+        // Leque: o vértice mais leve liga-se a todos, menos a ele mesmo e aos dois vizinhos.
+        int m = chain.size();
+        for (int t = 0; t < m; t++) {
+            int v = chain[t];
+            bool skip;
+            if (h == 0) skip = t <= 1 || t >= m - 2;
+            else if (apex == a) skip = t <= 1 || t == m - 1;
+            else skip = t == 0 || t >= m - 2;
+            if (!skip) addEdge(apex, v);
+        }
+    }
+
+    // --- Passo 6: Plano, com a divisão lida da triangulação ---
+    return planFromTriangulation(p, diagonals, plan);
+}
+
+/**
+ * @brief Produto exato de dois uint64_t em 128 bits (hi, lo), em C++ padrão.
+ */
+struct Wide {
+    uint64_t hi, lo;
+    bool operator>(const Wide& other) const { return hi != other.hi ? hi > other.hi : lo > other.lo; }
+};
+
+Wide multiplyWide(uint64_t x, uint64_t y) {
+    const uint64_t LOW = 0xffffffffu;
+    uint64_t ll = (x & LOW) * (y & LOW), lh = (x & LOW) * (y >> 32);
+    uint64_t hl = (x >> 32) * (y & LOW), hh = (x >> 32) * (y >> 32);
+    uint64_t mid = (ll >> 32) + (lh & LOW) + (hl & LOW); // Três parcelas < 2^32: não estoura
+    return {hh + (lh >> 32) + (hl >> 32) + (mid >> 32), (mid << 32) | (ll & LOW)};
+}
+
+/**
+ * @brief Ordem aproximada da cadeia em O(n), pelo algoritmo de Chin.
+ *
+ * No polígono girado (V0 = vértice mais leve), cortar o triângulo
+ * (V_{k-1}, V_k, V_{k+1}) antes de ligar V0 a V_k compensa quando
+ *
+ *   1/w_{k-1} + 1/w_{k+1} > 1/w_k + 1/w_0,
+ *
+ * que é comparar w_{k-1} w_k w_{k+1} + w_0 w_{k-1} w_{k+1} com o leque
+ * w_0 w_k (w_{k-1} + w_{k+1}). Uma varredura com pilha corta esses
+ * vértices assim que o vizinho da direita aparece (só picos passam no
+ * teste) e o que sobra vira um leque a partir de V0. O custo fica a no
+ * máximo 25% do ótimo (Chin, 1978). É O(n) no total: a varredura, o CSR e
+ * a leitura das divisões em planFromTriangulation são todos lineares.
+ *
+ * @param p Vetor de dimensões.
+ * @param plan Plano (saída), no formato de multiplyPlan.
+ * @return long long Custo do plano.
+ */
+long long chinOrder(const std::vector<int>& p, std::vector<MultiplyStep>& plan) {
+    plan.clear();
+    int n = (int)p.size() - 1;
+    if (n < 2) return 0;
+
+    int N = n + 1;
+    int shift = std::min_element(p.begin(), p.end()) - p.begin();
+    std::vector<long long> w(N + 1);
+    for (int v = 0; v <= N; v++) w[v] = p[(v + shift) % N];
+    std::vector<std::pair<int, int>> diagonals;
+    diagonals.reserve(n - 2);
+    auto addEdge = [&](int u, int v) { diagonals.push_back({(u + shift) % N, (v + shift) % N}); };
+
+    // 1/a + 1/c > 1/b + 1/w0, sem divisões: (a + c) b w0 > a c (b + w0).
+    // Os produtos chegam a 2^94 com dimensões int: em long long estouram
+    // acima de ~10^6. Cada lado é (fator < 2^33) · (fator < 2^62), feito
+    // exato em 128 bits por multiplyWide.
+    auto cutPays = [&](int a, int b, int c) {
+        return multiplyWide(w[a] + w[c], w[b] * w[0]) > multiplyWide(w[a] * w[c], w[b] + w[0]);
+    };
+    std::vector<int> stack = {0};
+    for (int c = 1; c < N; c++) {
+        while (stack.size() >= 2 && cutPays(stack[stack.size() - 2], stack.back(), c)) {
+            stack.pop_back();
+            addEdge(stack.back(), c); // Fecha o triângulo cortado
+        }
+        stack.push_back(c);
+    }
+    // Leque de V0 sobre o que sobrou: os vizinhos de V0 (stack[1] e o último) já são arestas.
+    for (size_t t = 2; t + 1 < stack.size(); t++) addEdge(0, stack[t]);
+    return planFromTriangulation(p, diagonals, plan);
+}
+
+// Até este n, planMatrixChain usa a DP exata (O(n^3), ~1 ms em n = 200).
+const int EXACT_CHAIN_LIMIT = 200;
+
+/**
+ * @brief Planejador: DP exata para cadeias curtas, Chin acima de exact_limit.
+ *
+ * A DP guarda custos em int. Se n * max(p)^3 (um limite para qualquer
+ * candidato da DP) não cabe em int, a cadeia curta vai para huShingOrder,
+ * que também é exato.
+ *
+ * @param p Vetor de dimensões.
+ * @param plan Plano (saída).
+ * @param exact_limit Maior n resolvido pela DP.
+ * @return long long Custo do plano.
+ */
+long long planMatrixChain(const std::vector<int>& p, std::vector<MultiplyStep>& plan,
+                          int exact_limit = EXACT_CHAIN_LIMIT) {
+    int n = (int)p.size() - 1;
+    if (n > exact_limit) return chinOrder(p, plan);
+    long long max_dim = n >= 1 ? *std::max_element(p.begin(), p.end()) : 0;
+    if ((long double)n * max_dim * max_dim * max_dim > INT_MAX) return huShingOrder(p, plan);
+    TriangularTable<int> s_table;
+    matrixChainOrder(p, s_table);
+    plan = multiplyPlan(s_table, p);
+    long long total = 0;
+    for (const MultiplyStep& step : plan) total += (long long)step.rows * step.inner * step.cols;
+    return total;
+}
+
+/**
+ * @brief Pico de memória dos intermediários ao executar um plano na ordem dada.
+ *
+ * Simula executeChain: o resultado de cada passo é alocado antes de os
+ * operandos intermediários serem liberados. As entradas não contam (já
+ * existem de qualquer jeito).
+ *
+ * É o pico de bytes vivos do modelo, não o que executeChain segura de
+ * fato: o BufferPool nunca devolve memória, então guarda também os buffers
+ * livres, e um pedido pode ser atendido por um buffer maior que ele. A
+ * memória retida pelo pool pode passar deste pico.
+ *
+ * @param plan Plano de multiplyPlan.
+ * @param n Número de matrizes.
+ * @param element_bytes Bytes por elemento (8 para double).
+ * @return long long Pico de bytes vivos.
+ */
+long long planPeakBytes(const std::vector<MultiplyStep>& plan, int n, int element_bytes = sizeof(double)) {
+    std::vector<long long> bytes(plan.size());
+    long long live = 0, peak = 0;
+    for (size_t t = 0; t < plan.size(); t++) {
+        const MultiplyStep& step = plan[t];
+        bytes[t] = (long long)step.rows * step.cols * element_bytes;
+        live += bytes[t];
+        peak = std::max(peak, live);
+        if (step.left >= n) live -= bytes[step.left - n];
+        if (step.right >= n) live -= bytes[step.right - n];
+    }
+    return peak;
+}
+
+/**
+ * @brief Resultado de matrixChainMemoryCapped.
+ */
+struct MemoryAwareCost {
+    long long flops;      // Multiplicações escalares
+    long long peak_bytes; // Pico de intermediários vivos
+    bool within_cap;      // false: nenhum plano achado cabe no limite (devolve o de menor pico)
+};
+
+/**
+ * @brief Cadeia de matrizes com limite de memória: menos multiplicações entre os planos com pico <= cap.
+ *
+ * Com a ordem de executeChain (esquerda, depois direita, depois o produto),
+ * o pico de (Ai...Aj) dividido em k é
+ *
+ *   max(pico_esq, tam_esq + pico_dir, tam_esq + tam_dir + tam(i, j))
+ *
+ * onde tam é o tamanho do resultado intermediário (0 para uma entrada).
+ * O pico cresce com os picos dos filhos, então a DP que minimiza só o pico
+ * é exata. Já "menos multiplicações com pico <= cap" não se decompõe: o
+ * lado direito tem de caber em cap - tam_esq, que muda com o contexto, e o
+ * exato exigiria guardar uma curva por célula. Para ficar em O(n^3), cada
+ * célula guarda dois candidatos:
+ *
+ * - A: menos multiplicações com pico <= cap (empate: menor pico);
+ * - B: menor pico (empate: menos multiplicações), exato.
+ *
+ * e cada divisão k testa as 4 combinações de candidatos dos filhos. Se B
+ * da cadeia inteira passa do limite, nenhum plano cabe. Fora isso, A é uma
+ * heurística: pode perder planos viáveis que combinam subplanos
+ * intermediários (nem os mais baratos, nem os de menor pico). Contra a
+ * fronteira exata (força bruta, n <= 12) ela erra poucos limites, por
+ * alguns por cento (o teste do main mostra quantos e a pior razão).
+ *
+ * O limite vale para o modelo de planPeakBytes; o BufferPool de
+ * executeChain retém mais que isso (veja planPeakBytes).
+ *
+ * @param p Vetor de dimensões.
+ * @param cap Limite de bytes vivos (LLONG_MAX = sem limite).
+ * @param s_table Tabela de divisões do plano escolhido (saída), para multiplyPlan.
+ * @param element_bytes Bytes por elemento (8 para double).
+ * @return MemoryAwareCost Multiplicações e pico do plano escolhido.
+ */
+MemoryAwareCost matrixChainMemoryCapped(const std::vector<int>& p, long long cap, TriangularTable<int>& s_table,
+                                        int element_bytes = sizeof(double)) {
+    int n = (int)p.size() - 1;
+    s_table.assign(std::max(n, 0));
+    if (n < 2) return {0, 0, true};
+
+    const long long INF = LLONG_MAX;
+    // Candidatos A (índice 0) e B (índice 1) de cada célula.
+    TriangularTable<long long> flops[2] = {TriangularTable<long long>(n), TriangularTable<long long>(n)};
+    TriangularTable<long long> peak[2] = {TriangularTable<long long>(n), TriangularTable<long long>(n)};
+    TriangularTable<int> split[2] = {TriangularTable<int>(n), TriangularTable<int>(n)};
+    TriangularTable<unsigned char> child[2] = {TriangularTable<unsigned char>(n), TriangularTable<unsigned char>(n)};
+    auto resultBytes = [&](int i, int j) {
+        return i == j ? 0LL : (long long)p[i - 1] * p[j] * element_bytes;
+    };
+
+    // --- Passo 1: Casos base (L = 1): entradas, sem custo nem memória ---
+    // --- Passo 2: Diagonais, como no livro ---
+    for (int L = 2; L <= n; L++) {
+        for (int i = 1; i <= n - L + 1; i++) {
+            int j = i + L - 1;
+            long long best_flops[2] = {INF, INF}, best_peak[2] = {INF, INF};
+            for (int k = i; k < j; k++) {
+                long long own = (long long)p[i - 1] * p[k] * p[j];
+                long long left_bytes = resultBytes(i, k), right_bytes = resultBytes(k + 1, j);
+                long long out_bytes = resultBytes(i, j);
+                for (int combo = 0; combo < 4; combo++) {
+                    int lc = combo & 1, rc = combo >> 1; // 0 = candidato A, 1 = candidato B
+                    long long left_flops = flops[lc][i][k], right_flops = flops[rc][k + 1][j];
+                    if (left_flops == INF || right_flops == INF) continue; // A inviável no filho
+                    long long total = left_flops + right_flops + own;
+                    long long total_peak = std::max({peak[lc][i][k], left_bytes + peak[rc][k + 1][j],
+                                                     left_bytes + right_bytes + out_bytes});
+                    if (total_peak <= cap && (total < best_flops[0] || (total == best_flops[0] && total_peak < best_peak[0]))) {
+                        best_flops[0] = total;
+                        best_peak[0] = total_peak;
+                        split[0][i][j] = k;
+                        child[0][i][j] = combo;
+                    }
+                    if (total_peak < best_peak[1] || (total_peak == best_peak[1] && total < best_flops[1])) {
+                        best_flops[1] = total;
+                        best_peak[1] = total_peak;
+                        split[1][i][j] = k;
+                        child[1][i][j] = combo;
+                    }
+                }
+            }
+            for (int c = 0; c < 2; c++) {
+                flops[c][i][j] = best_flops[c];
+                peak[c][i][j] = best_peak[c];
+            }
+        }
+    }
+
+    // --- Passo 3: Divisões do candidato escolhido, de cima para baixo ---
+    int root = flops[0][1][n] != INF ? 0 : 1;
+    struct Item { int i, j, candidate; };
+    std::vector<Item> stack = {{1, n, root}};
+    while (!stack.empty()) {
+        Item item = stack.back();
+        stack.pop_back();
+        if (item.i == item.j) continue;
+        int k = split[item.candidate][item.i][item.j];
+        int combo = child[item.candidate][item.i][item.j];
+        s_table[item.i][item.j] = k;
+        stack.push_back({item.i, k, combo & 1});
+        stack.push_back({k + 1, item.j, combo >> 1});
+    }
+    return {flops[root][1][n], peak[root][1][n], root == 0};
+}
+
+/**
+ * @brief Fronteira de Pareto (multiplicações, pico) aproximada, apertando o limite de matrixChainMemoryCapped.
+ *
+ * Começa sem limite (o plano de menos multiplicações) e, a cada passo,
+ * pede um pico menor que o do último ponto, até chegar ao plano de menor
+ * pico. Cada passo é uma DP O(n^3); max_points limita quantos.
+ *
+ * @param p Vetor de dimensões.
+ * @param max_points Máximo de pontos.
+ * @param element_bytes Bytes por elemento.
+ * @return std::vector<MemoryAwareCost> Pontos, do mais rápido ao mais enxuto.
+ */
+std::vector<MemoryAwareCost> matrixChainParetoFront(const std::vector<int>& p, int max_points = 16,
+                                                    int element_bytes = sizeof(double)) {
+    std::vector<MemoryAwareCost> front;
+    TriangularTable<int> s_table;
+    long long cap = LLONG_MAX;
+    while ((int)front.size() < max_points) {
+        MemoryAwareCost point = matrixChainMemoryCapped(p, cap, s_table, element_bytes);
+        if (!point.within_cap) break;
+        front.push_back(point);
+        if (point.peak_bytes == 0) break;
+        cap = point.peak_bytes - 1;
+    }
+    return front;
+}
+
+/**
+ * @brief Matriz densa em ordem de linhas (row-major).
+ */
+template <typename T>
+struct DenseMatrix {
+    int rows = 0, cols = 0;
+    std::vector<T> data;
+
+    T* row(int i) { return data.data() + (size_t)i * cols; }
+    const T* row(int i) const { return data.data() + (size_t)i * cols; }
+};
+
+/**
+ * @brief Guarda os buffers dos resultados intermediários para reaproveitá-los.
+ *
+ * Cada resultado do plano é usado uma única vez, então o buffer dos dois
+ * operandos pode voltar para o pool logo depois do passo. acquire escolhe
+ * o menor buffer livre que comporta o pedido e só aloca se nenhum serve.
+ * Um mutex protege a lista, para vários passos rodarem ao mesmo tempo.
+ */
+template <typename T>
+class BufferPool {
+public:
+    std::vector<T> acquire(size_t size) {
+        std::lock_guard<std::mutex> lock(mutex);
+        int best = -1;
+        for (int b = 0; b < (int)free_buffers.size(); b++) {
+            size_t capacity = free_buffers[b].capacity();
+            if (capacity >= size && (best < 0 || capacity < free_buffers[best].capacity())) best = b;
+        }
+        if (best < 0) {
+            allocations++;
+            return std::vector<T>(size);
+        }
+        std::vector<T> buffer = std::move(free_buffers[best]);
+        free_buffers.erase(free_buffers.begin() + best);
+        buffer.resize(size);
+        return buffer;
+    }
+
+    void release(std::vector<T>&& buffer) {
+        if (buffer.capacity() == 0) return;
+        std::lock_guard<std::mutex> lock(mutex);
+        free_buffers.push_back(std::move(buffer));
+    }
+
+    int allocations = 0; // Quantas vezes foi preciso alocar de verdade
+
+private:
+    std::mutex mutex;
+    std::vector<std::vector<T>> free_buffers;
+};
+
+// Blocos do GEMM: um painel KC x NC de B (128 x 512 doubles = 512 KB) fica
+// no L2 enquanto todas as linhas de A passam por ele.
+const int GEMM_KC = 128;
+const int GEMM_NC = 512;
+const int GEMM_ROWS = 4; // Linhas de C atualizadas juntas a cada linha de B lida
+
+// Vetor SIMD de 16 bytes (2 doubles ou 4 floats), pela extensão de vetores
+// do g++/clang: é o SSE2 que todo x86-64 tem, sem depender de -march.
+template <typename T>
+struct SimdVector {
+    typedef T type __attribute__((vector_size(16)));
+    static const int lanes = 16 / sizeof(T);
+
+    static type load(const T* from) {
+        type v;
+        std::memcpy(&v, from, sizeof(v)); // Leitura não alinhada
+        return v;
+    }
+    static void store(T* to, type v) { std::memcpy(to, &v, sizeof(v)); }
+};
+
+/**
+ * @brief C[i0..i1) += A[i0..i1) * B, com blocos de cache (C já zerada).
+ *
+ * O laço de dentro percorre uma linha de B e GEMM_ROWS linhas de C de forma
+ * contígua, um SimdVector por vez; cada vetor de B lido serve a 4 linhas.
+ * As colunas que sobram no fim do bloco vão escalares. O -O2 do g++ 12 não
+ * vetoriza esse laço sozinho (exigiria um epílogo escalar), daí os vetores
+ * explícitos.
+ */
+template <typename T>
+void gemmRows(const T* A, const T* B, T* C, int K, int N, int i0, int i1) {
+    typedef SimdVector<T> V;
+    typedef typename V::type Vec;
+    for (int kk = 0; kk < K; kk += GEMM_KC) {
+        int k_end = std::min(K, kk + GEMM_KC);
+        for (int jj = 0; jj < N; jj += GEMM_NC) {
+            int j_end = std::min(N, jj + GEMM_NC);
+            int j_vec = jj + (j_end - jj) / V::lanes * V::lanes;
+            int i = i0;
+            for (; i + GEMM_ROWS <= i1; i += GEMM_ROWS) {
+                T* c0 = C + (size_t)i * N;
+                T* c1 = c0 + N;
+                T* c2 = c1 + N;
+                T* c3 = c2 + N;
+                for (int k = kk; k < k_end; k++) {
+                    const T* b = B + (size_t)k * N;
+                    T a0 = A[(size_t)i * K + k], a1 = A[(size_t)(i + 1) * K + k];
+                    T a2 = A[(size_t)(i + 2) * K + k], a3 = A[(size_t)(i + 3) * K + k];
+                    int j = jj;
+                    for (; j < j_vec; j += V::lanes) {
+                        Vec bj = V::load(b + j);
+                        V::store(c0 + j, V::load(c0 + j) + a0 * bj);
+                        V::store(c1 + j, V::load(c1 + j) + a1 * bj);
+                        V::store(c2 + j, V::load(c2 + j) + a2 * bj);
+                        V::store(c3 + j, V::load(c3 + j) + a3 * bj);
+                    }
+                    for (; j < j_end; j++) {
+                        T bj = b[j];
+                        c0[j] += a0 * bj;
+                        c1[j] += a1 * bj;
+                        c2[j] += a2 * bj;
+                        c3[j] += a3 * bj;
+                    }
+                }
+            }
+            for (; i < i1; i++) {
+                T* c = C + (size_t)i * N;
+                for (int k = kk; k < k_end; k++) {
+                    const T* b = B + (size_t)k * N;
+                    T a = A[(size_t)i * K + k];
+                    int j = jj;
+                    for (; j < j_vec; j += V::lanes) V::store(c + j, V::load(c + j) + a * V::load(b + j));
+                    for (; j < j_end; j++) c[j] += a * b[j];
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Quantas das 'threads' um GEMM M x K x N usa de fato.
+ *
+ * Cada thread precisa de ~1 milhão de multiplicações (criar threads custaria
+ * mais que a conta) e de pelo menos GEMM_ROWS linhas de C.
+ */
+int gemmThreads(int M, int K, int N, int threads) {
+    long long work = (long long)M * K * N;
+    threads = (int)std::min<long long>(threads, std::max(1LL, work / (1LL << 20)));
+    return std::max(1, std::min(threads, M / GEMM_ROWS));
+}
+
+/**
+ * @brief C = A * B com o kernel em blocos, dividindo as linhas de C entre threads (até gemmThreads).
+ *
+ * @param threads Número de threads (1 = serial, 0 = hardware_concurrency).
+ */
+template <typename T>
+void gemm(const DenseMatrix<T>& A, const DenseMatrix<T>& B, DenseMatrix<T>& C, int threads = 1) {
+    int M = A.rows, K = A.cols, N = B.cols;
+    C.rows = M;
+    C.cols = N;
+    C.data.assign((size_t)M * N, T(0));
+    if (threads <= 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = gemmThreads(M, K, N, threads);
+    if (threads == 1) {
+        gemmRows(A.data.data(), B.data.data(), C.data.data(), K, N, 0, M);
+        return;
+    }
+    // Faixas de linhas múltiplas de GEMM_ROWS, uma por thread.
+    int band = ((M + threads - 1) / threads + GEMM_ROWS - 1) / GEMM_ROWS * GEMM_ROWS;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        int i0 = t * band, i1 = std::min(M, i0 + band);
+        if (i0 >= i1) break;
+        workers.emplace_back([&, i0, i1] { gemmRows(A.data.data(), B.data.data(), C.data.data(), K, N, i0, i1); });
+    }
+    for (std::thread& worker : workers) worker.join();
+}
+
+/**
+ * @brief Executa o plano de multiplyPlan sobre matrizes de verdade.
+ *
+ * Os passos rodam na ordem do plano (pós-ordem), com o GEMM em blocos. Os
+ * intermediários saem do pool e voltam para ele assim que são consumidos,
+ * então a memória de pico acompanha a parentização, não o número de passos.
+ *
+ * @param plan Plano de multiplyPlan.
+ * @param inputs As matrizes A1..An (operandos 0..n-1).
+ * @param pool Pool de buffers dos intermediários.
+ * @param threads Threads de cada GEMM (1 = serial, 0 = hardware_concurrency).
+ * @return DenseMatrix<T> O produto A1...An.
+ */
+template <typename T>
+DenseMatrix<T> executeChain(const std::vector<MultiplyStep>& plan, const std::vector<DenseMatrix<T>>& inputs,
+                            BufferPool<T>& pool, int threads = 1) {
+    int n = inputs.size();
+    if (plan.empty()) return n > 0 ? inputs[0] : DenseMatrix<T>();
+
+    std::vector<DenseMatrix<T>> results(plan.size());
+    auto operand = [&](int id) -> const DenseMatrix<T>& { return id < n ? inputs[id] : results[id - n]; };
+    for (const MultiplyStep& step : plan) {
+        DenseMatrix<T>& out = results[step.result - n];
+        out.data = pool.acquire((size_t)step.rows * step.cols);
+        gemm(operand(step.left), operand(step.right), out, threads);
+        // Os operandos intermediários não serão usados de novo.
+        if (step.left >= n) pool.release(std::move(results[step.left - n].data));
+        if (step.right >= n) pool.release(std::move(results[step.right - n].data));
+    }
+    return std::move(results.back());
+}
+
+/**
+ * @brief Referência ingênua: da esquerda para a direita, com o laço triplo i-j-k.
+ */
+template <typename T>
+DenseMatrix<T> naiveChain(const std::vector<DenseMatrix<T>>& inputs) {
+    DenseMatrix<T> acc = inputs[0];
+    for (size_t m = 1; m < inputs.size(); m++) {
+        const DenseMatrix<T>& B = inputs[m];
+        DenseMatrix<T> next;
+        next.rows = acc.rows;
+        next.cols = B.cols;
+        next.data.assign((size_t)next.rows * next.cols, T(0));
+        for (int i = 0; i < acc.rows; i++) {
+            for (int j = 0; j < B.cols; j++) {
+                T sum = 0;
+                for (int k = 0; k < acc.cols; k++) sum += acc.row(i)[k] * B.row(k)[j];
+                next.row(i)[j] = sum;
+            }
+        }
+        acc = std::move(next);
+    }
+    return acc;
+}
+
+/**
+ * @brief Tempo de um plano no modelo de caminho crítico de matrixChainCriticalPath.
+ *
+ * @param plan Plano de multiplyPlan.
+ * @param n Número de matrizes.
+ * @param cores Núcleos do modelo (>= 1).
+ * @return double Tempo modelado, em multiplicações escalares por núcleo.
+ */
+double criticalPathTime(const std::vector<MultiplyStep>& plan, int n, int cores) {
+    std::vector<double> time(plan.size()), work(plan.size());
+    for (size_t t = 0; t < plan.size(); t++) {
+        const MultiplyStep& step = plan[t];
+        double own = (double)step.rows * step.inner * step.cols;
+        double left_time = step.left >= n ? time[step.left - n] : 0;
+        double right_time = step.right >= n ? time[step.right - n] : 0;
+        double children_work = (step.left >= n ? work[step.left - n] : 0) + (step.right >= n ? work[step.right - n] : 0);
+        time[t] = std::max({left_time, right_time, children_work / cores})
+                  + own / gemmThreads(step.rows, step.inner, step.cols, cores);
+        work[t] = children_work + own;
+    }
+    return plan.empty() ? 0.0 : time.back();
+}
+
+/**
+ * @brief Parentização que minimiza o caminho crítico com 'cores' núcleos, em vez do total de multiplicações.
+ *
+ * Modelo (heurístico, no espírito do limite de Brent): um intervalo [i, j]
+ * dividido em k termina em
+ *
+ *   T[i][j] = max(T[i][k], T[k+1][j], (W[i][k] + W[k+1][j]) / cores)
+ *             + p[i-1]*p[k]*p[j] / gemmThreads(p[i-1], p[k], p[j], cores)
+ *
+ * onde W é o trabalho total da subárvore escolhida. As duas metades rodam
+ * juntas, então conta o caminho mais longo, mas nunca menos que o trabalho
+ * delas dividido pelos núcleos. A última multiplicação usa quantos núcleos
+ * o GEMM consegue aproveitar: produtos pequenos ficam quase seriais, e é aí
+ * que rodar subárvores em paralelo compensa. Com cores = 1 isso vira T = W,
+ * o custo clássico, e a escolha é a do livro.
+ * Guardar um único (T, W) por intervalo faz a DP ser uma heurística: o
+ * ótimo exato teria de guardar a fronteira inteira de pares. Empates em T
+ * ficam com o menor W, e se o plano clássico sair melhor no modelo, ele é
+ * que é devolvido: o resultado nunca é pior que matrixChainOrder.
+ *
+ * @param p Vetor de dimensões.
+ * @param cores Núcleos do modelo (>= 1).
+ * @param s_table Tabela de divisões (saída), no formato de matrixChainOrder.
+ * @return double Tempo modelado, em multiplicações escalares por núcleo.
+ */
+double matrixChainCriticalPath(const std::vector<int>& p, int cores, TriangularTable<int>& s_table) {
+    if (p.size() < 2) {
+        return 0;
+    }
+    int n = p.size() - 1;
+    TriangularTable<double> time_table(n), work_table(n);
+    s_table.assign(n);
+    for (int L = 2; L <= n; L++) {
+        for (int i = 1; i <= n - L + 1; i++) {
+            int j = i + L - 1;
+            time_table[i][j] = std::numeric_limits<double>::infinity();
+            for (int k = i; k < j; k++) {
+                double own = (double)p[i - 1] * p[k] * p[j];
+                double children_work = work_table[i][k] + work_table[k + 1][j];
+                double time = std::max({time_table[i][k], time_table[k + 1][j], children_work / cores})
+                              + own / gemmThreads(p[i - 1], p[k], p[j], cores);
+                double work = children_work + own;
+                if (time < time_table[i][j] || (time == time_table[i][j] && work < work_table[i][j])) {
+                    time_table[i][j] = time;
+                    work_table[i][j] = work;
+                    s_table[i][j] = k;
+                }
+            }
+        }
+    }
+
+    TriangularTable<int> classic_split;
+    matrixChainOrder(p, classic_split);
+    double classic_time = criticalPathTime(multiplyPlan(classic_split, p), n, cores);
+    if (classic_time < time_table[1][n]) {
+        s_table = std::move(classic_split);
+        return classic_time;
+    }
+    return time_table[1][n];
+}
+
+/**
+ * @brief Quantas threads cada passo do plano pode usar no seu GEMM.
+ *
+ * A raiz fica com todas. Quando os dois operandos de um passo são
+ * resultados de outros passos, as duas subárvores rodam ao mesmo tempo e
+ * dividem as threads do pai na proporção do seu trabalho (pelo menos uma
+ * cada). Um filho sozinho herda tudo.
+ *
+ * O orçamento é um teto por passo, não uma reserva: um pai com 1 thread
+ * ainda dá 1 a cada filho, e os dois podem ficar prontos juntos, somando 2.
+ * Quem garante o total é executeChainParallel, que só entrega núcleos
+ * livres (no máximo 'threads' ao mesmo tempo); um passo que pede mais do
+ * que há livre roda com menos.
+ *
+ * @param plan Plano de multiplyPlan (pós-ordem: filhos antes do pai).
+ * @param n Número de matrizes de entrada.
+ * @param threads Threads disponíveis.
+ * @return std::vector<int> Threads de cada passo.
+ */
+std::vector<int> planThreadBudget(const std::vector<MultiplyStep>& plan, int n, int threads) {
+    int steps = plan.size();
+    std::vector<double> subtree_work(steps);
+    for (int t = 0; t < steps; t++) {
+        const MultiplyStep& step = plan[t];
+        subtree_work[t] = (double)step.rows * step.inner * step.cols;
+        if (step.left >= n) subtree_work[t] += subtree_work[step.left - n];
+        if (step.right >= n) subtree_work[t] += subtree_work[step.right - n];
+    }
+    std::vector<int> budget(steps, 1);
+    if (steps == 0) return budget;
+    budget[steps - 1] = threads;
+    for (int t = steps - 1; t >= 0; t--) { // Pai antes dos filhos
+        const MultiplyStep& step = plan[t];
+        bool left_step = step.left >= n, right_step = step.right >= n;
+        if (left_step && right_step) {
+            double left_work = subtree_work[step.left - n], right_work = subtree_work[step.right - n];
+            int left_threads = (int)std::lround(budget[t] * left_work / (left_work + right_work));
+            left_threads = std::max(1, std::min(budget[t] - 1, left_threads));
+            budget[step.left - n] = left_threads;
+            budget[step.right - n] = std::max(1, budget[t] - left_threads);
+        } else if (left_step) {
+            budget[step.left - n] = budget[t];
+        } else if (right_step) {
+            budget[step.right - n] = budget[t];
+        }
+    }
+    return budget;
+}
+
+/**
+ * @brief Executa o plano como um grafo de tarefas, com roubo de trabalho.
+ *
+ * Cada passo é uma tarefa que depende dos passos que produzem os seus
+ * operandos. Cada thread tem a sua fila: tira tarefas do fim da própria
+ * fila e, quando ela esvazia, rouba do começo da fila das outras. Quem
+ * termina o segundo operando de um passo põe esse passo na própria fila,
+ * então a subárvore tende a ficar na mesma thread (e na mesma cache).
+ * Subárvores independentes, como (A2A3) e (A4A5) no exemplo do Cormen,
+ * rodam ao mesmo tempo, e o GEMM de cada passo usa as threads de
+ * planThreadBudget, limitadas aos núcleos livres: a soma das threads em uso
+ * (trabalhadoras + as do GEMM) nunca passa de 'threads'. Trabalhadoras sem
+ * tarefa ou sem núcleo dormem numa variável de condição, acordada quando um
+ * passo termina (libera núcleos e talvez o pai) ou quando tudo acabou.
+ *
+ * Só a correção foi conferida: a máquina de desenvolvimento tem um único
+ * núcleo, então nenhum ganho de tempo foi medido.
+ *
+ * Cada elemento de cada resultado é calculado pelas mesmas contas que em
+ * executeChain, então o produto é idêntico bit a bit.
+ *
+ * @param plan Plano de multiplyPlan.
+ * @param inputs As matrizes A1..An.
+ * @param pool Pool de buffers dos intermediários.
+ * @param threads Número de threads (1 = serial, 0 = hardware_concurrency).
+ * @return DenseMatrix<T> O produto A1...An.
+ */
+template <typename T>
+DenseMatrix<T> executeChainParallel(const std::vector<MultiplyStep>& plan, const std::vector<DenseMatrix<T>>& inputs,
+                                    BufferPool<T>& pool, int threads = 0) {
+    if (threads <= 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    int n = inputs.size(), steps = plan.size();
+    if (threads == 1 || steps < 2) return executeChain(plan, inputs, pool, threads);
+
+    // --- Passo 1: Grafo de dependências ---
+    std::vector<int> parent(steps, -1);
+    std::vector<std::atomic<int>> pending(steps);
+    for (int t = 0; t < steps; t++) {
+        int operands_from_steps = 0;
+        for (int id : {plan[t].left, plan[t].right}) {
+            if (id >= n) {
+                parent[id - n] = t;
+                operands_from_steps++;
+            }
+        }
+        pending[t].store(operands_from_steps, std::memory_order_relaxed);
+    }
+    std::vector<int> budget = planThreadBudget(plan, n, threads);
+
+    // --- Passo 2: Folhas distribuídas entre as filas ---
+    struct TaskQueue {
+        std::mutex mutex;
+        std::deque<int> tasks;
+    };
+    std::vector<TaskQueue> queues(threads);
+    std::atomic<int> queued(0); // Tarefas nas filas (para as threads ociosas)
+    int next_queue = 0;
+    for (int t = 0; t < steps; t++) {
+        if (pending[t].load(std::memory_order_relaxed) == 0) {
+            queues[next_queue].tasks.push_back(t);
+            queued.fetch_add(1, std::memory_order_relaxed);
+            next_queue = (next_queue + 1) % threads;
+        }
+    }
+
+    // --- Passo 3: Threads com roubo de trabalho ---
+    std::vector<DenseMatrix<T>> results(steps);
+    auto operand = [&](int id) -> const DenseMatrix<T>& { return id < n ? inputs[id] : results[id - n]; };
+    std::atomic<int> remaining(steps);
+    // Núcleos livres e a variável de condição das threads ociosas. Quem muda
+    // 'queued', 'remaining' ou 'free_cores' passa por idle_mutex antes de
+    // notificar, então nenhuma thread perde o aviso entre testar e dormir.
+    std::mutex idle_mutex;
+    std::condition_variable wake;
+    int free_cores = threads;
+    auto take = [&](int self, int& task) {
+        {
+            std::lock_guard<std::mutex> lock(queues[self].mutex);
+            if (!queues[self].tasks.empty()) {
+                task = queues[self].tasks.back();
+                queues[self].tasks.pop_back();
+                queued.fetch_sub(1, std::memory_order_acq_rel);
+                return true;
+            }
+        }
+        for (int offset = 1; offset < threads; offset++) {
+            TaskQueue& victim = queues[(self + offset) % threads];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = victim.tasks.front();
+                victim.tasks.pop_front();
+                queued.fetch_sub(1, std::memory_order_acq_rel);
+                return true;
+            }
+        }
+        return false;
+    };
+    auto worker = [&](int self) {
+        while (true) {
+            int t;
+            if (!take(self, t)) {
+                std::unique_lock<std::mutex> lock(idle_mutex);
+                wake.wait(lock, [&] {
+                    return queued.load(std::memory_order_acquire) > 0 || remaining.load(std::memory_order_acquire) == 0;
+                });
+                if (remaining.load(std::memory_order_acquire) == 0) return;
+                continue;
+            }
+
+            // Reserva um núcleo para esta thread e, se houver, os extras do orçamento.
+            int cores;
+            {
+                std::unique_lock<std::mutex> lock(idle_mutex);
+                wake.wait(lock, [&] { return free_cores > 0; });
+                cores = std::min(budget[t], free_cores);
+                free_cores -= cores;
+            }
+            const MultiplyStep& step = plan[t];
+            DenseMatrix<T>& out = results[t];
+            out.data = pool.acquire((size_t)step.rows * step.cols);
+            gemm(operand(step.left), operand(step.right), out, cores);
+            if (step.left >= n) pool.release(std::move(results[step.left - n].data));
+            if (step.right >= n) pool.release(std::move(results[step.right - n].data));
+            // O último operando pronto libera o pai, na fila desta thread.
+            if (parent[t] >= 0 && pending[parent[t]].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::lock_guard<std::mutex> lock(queues[self].mutex);
+                queues[self].tasks.push_back(parent[t]);
+                queued.fetch_add(1, std::memory_order_acq_rel);
+            }
+            remaining.fetch_sub(1, std::memory_order_acq_rel);
+            {
+                std::lock_guard<std::mutex> lock(idle_mutex);
+                free_cores += cores;
+            }
+            wake.notify_all();
+        }
+    };
+    std::vector<std::thread> workers;
+    for (int w = 1; w < threads; w++) workers.emplace_back(worker, w);
+    worker(0);
+    for (std::thread& thread : workers) thread.join();
+    return std::move(results.back());
+}
+
 // Main para teste
-int main() {
+int main(int argc, char* argv[]) {
     // Este é o exemplo clássico do Cormen (Cap. 15).
     // Temos 6 matrizes (n=6).
     // A1: 30x35
@@ -140,10 +1435,19 @@ int main() {
     int n_matrizes = dims.size() - 1;
     std::cout << "Numero de matrizes: " << n_matrizes << std::endl;
     
-    int min_cost = matrixChainOrder(dims);
+    TriangularTable<int> s_table;
+    int min_cost = matrixChainOrder(dims, s_table);
     
     std::cout << "Custo minimo de multiplicacoes: " << min_cost << std::endl;
     // Resultado esperado: 15125
+    std::cout << "Parentizacao otima: " << optimalParens(s_table, n_matrizes) << std::endl;
+    // Resultado esperado: ((A1(A2A3))((A4A5)A6))
+    std::cout << "Plano (operandos 0..5 = A1..A6):" << std::endl;
+    for (const MultiplyStep& step : multiplyPlan(s_table, dims)) {
+        std::cout << "\t" << step.result << " = " << step.left << " * " << step.right << "  ("
+                  << step.rows << "x" << step.inner << " * " << step.inner << "x" << step.cols << ", "
+                  << (long long)step.rows * step.inner * step.cols << " mult.)" << std::endl;
+    }
 
     std::cout << "---" << std::endl;
 
@@ -165,8 +1469,461 @@ int main() {
 
     std::vector<int> dims2 = {10, 20, 30, 10};
     std::cout << "Numero de matrizes: " << (dims2.size() - 1) << std::endl;
-    std::cout << "Custo minimo de multiplicacoes: " << matrixChainOrder(dims2) << std::endl;
+    TriangularTable<int> s_table2;
+    std::cout << "Custo minimo de multiplicacoes: " << matrixChainOrder(dims2, s_table2) << std::endl;
     // Resultado esperado: 8000
+    std::cout << "Parentizacao otima: " << optimalParens(s_table2, 3) << std::endl;
+    // Resultado esperado: (A1(A2A3))
+
+    std::cout << "---" << std::endl;
+
+    // --- Comparação de layouts: tabela aninhada vs triangular por diagonal ---
+    // Dimensões pequenas (1 a 10) para o custo caber em int.
+    // Com "--bench", n = 5000 (O(n^3): alguns minutos no total).
+    bool bench = argc > 1 && std::string(argv[1]) == "--bench";
+    int n_big = bench ? 5000 : 1000;
+    std::mt19937 rng(2024);
+    std::vector<int> dims_big(n_big + 1);
+    for (int& d : dims_big) d = 1 + rng() % 10;
+
+    std::cout << "Layout da tabela, n = " << n_big << " matrizes:" << std::endl;
+    PerfCounter llc_misses(PerfCounter::CACHE_MISSES), l1_misses(PerfCounter::L1D_READ_MISSES);
+    auto counterText = [](long long count) { return count < 0 ? std::string("n/d") : std::to_string(count); };
+    auto timeLayout = [&](const char* label, auto&& solve, double megabytes) {
+        llc_misses.start();
+        l1_misses.start();
+        auto start = std::chrono::steady_clock::now();
+        int cost = solve();
+        auto stop = std::chrono::steady_clock::now();
+        long long l1 = l1_misses.stop(), llc = llc_misses.stop();
+        std::cout << "\t" << label << ": " << megabytes << " MB, "
+                  << std::chrono::duration<double, std::milli>(stop - start).count() << " ms, faltas L1d "
+                  << counterText(l1) << ", faltas LLC " << counterText(llc) << ", custo " << cost << std::endl;
+    };
+    double nested_mb = (n_big + 2.0) * (n_big + 2.0) * sizeof(int) / 1e6;
+    double packed_mb = TriangularTable<int>(n_big).bytes() / 1e6;
+    timeLayout("aninhado, k por dentro             ", [&] {
+        std::vector<std::vector<int>> nested;
+        return matrixChainCost(dims_big, nested);
+    }, nested_mb);
+    timeLayout("triangular, k por dentro           ", [&] {
+        TriangularTable<int> packed;
+        return matrixChainCost(dims_big, packed);
+    }, packed_mb);
+    timeLayout("triangular, i por dentro (em fluxo)", [&] { return matrixChainOrder(dims_big); }, packed_mb);
+    if (!llc_misses.available()) std::cout << "\t(contadores de hardware indisponiveis nesta maquina)" << std::endl;
+    std::cout << "---" << std::endl;
+
+    // --- Varredura paralela das diagonais ---
+    // A tabela com threads tem de ser idêntica, bit a bit, à serial.
+    int n_par = 2000;
+    std::vector<int> dims_par(n_par + 1);
+    for (int& d : dims_par) d = 1 + rng() % 10;
+    std::cout << "Varredura paralela, n = " << n_par << " matrizes (hardware_concurrency = "
+              << std::thread::hardware_concurrency() << "):" << std::endl;
+    TriangularTable<int> serial_table, serial_split;
+    auto start = std::chrono::steady_clock::now();
+    int serial_cost = matrixChainTable(dims_par, serial_table, serial_split, 1);
+    auto stop = std::chrono::steady_clock::now();
+    double serial_ms = std::chrono::duration<double, std::milli>(stop - start).count();
+    std::cout << "\t1 thread : " << serial_ms << " ms, custo " << serial_cost << std::endl;
+
+    // Identidade com 2 e 4 threads, sempre, qualquer que seja o número de
+    // núcleos. Usa uma cadeia menor para não pesar onde há um núcleo só.
+    {
+        std::vector<int> dims_check(dims_par.begin(), dims_par.begin() + 501);
+        TriangularTable<int> check_table, check_split;
+        matrixChainTable(dims_check, check_table, check_split, 1);
+        for (int threads : {2, 4}) {
+            TriangularTable<int> parallel_table, parallel_split;
+            matrixChainTable(dims_check, parallel_table, parallel_split, threads);
+            bool identical = parallel_table.data == check_table.data && parallel_split.data == check_split.data;
+            std::cout << "\tn = 500, " << threads << " threads (forcadas): tabela identica: "
+                      << (identical ? "sim" : "NAO") << std::endl;
+        }
+    }
+
+    // Tempo: mais threads que núcleos só mediriam a troca de contexto.
+    int cores = (int)std::max(1u, std::thread::hardware_concurrency());
+    int measured = 1;
+    for (int wanted : {2, 4}) {
+        int threads = std::min(wanted, cores);
+        if (threads == measured) continue;
+        measured = threads;
+        TriangularTable<int> parallel_table, parallel_split;
+        start = std::chrono::steady_clock::now();
+        int cost = matrixChainTable(dims_par, parallel_table, parallel_split, threads);
+        stop = std::chrono::steady_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(stop - start).count();
+        bool identical = parallel_table.data == serial_table.data && parallel_split.data == serial_split.data;
+        std::cout << "\t" << threads << " threads: " << ms << " ms (serial / paralelo = " << serial_ms / ms
+                  << "x), custo " << cost << ", tabela identica: " << (identical ? "sim" : "NAO") << std::endl;
+    }
+    if (cores == 1) std::cout << "\t(um nucleo so: tempo paralelo nao medido)" << std::endl;
+    std::cout << "---" << std::endl;
+
+    // --- Plano de execução ---
+    // O plano deve encadear dimensões compatíveis, usar cada operando uma
+    // única vez e somar exatamente o custo ótimo.
+    std::vector<MultiplyStep> plan = multiplyPlan(serial_split, dims_par);
+    std::vector<int> rows_of(2 * n_par - 1), cols_of(2 * n_par - 1), uses(2 * n_par - 1, 0);
+    for (int a = 0; a < n_par; a++) {
+        rows_of[a] = dims_par[a];
+        cols_of[a] = dims_par[a + 1];
+    }
+    long long plan_cost = 0;
+    bool consistent = (int)plan.size() == n_par - 1;
+    for (const MultiplyStep& step : plan) {
+        consistent = consistent && step.left < step.result && step.right < step.result
+                     && rows_of[step.left] == step.rows && cols_of[step.left] == step.inner
+                     && rows_of[step.right] == step.inner && cols_of[step.right] == step.cols;
+        uses[step.left]++;
+        uses[step.right]++;
+        rows_of[step.result] = step.rows;
+        cols_of[step.result] = step.cols;
+        plan_cost += (long long)step.rows * step.inner * step.cols;
+    }
+    for (int id = 0; id < 2 * n_par - 2; id++) consistent = consistent && uses[id] == 1;
+    std::string parens = optimalParens(serial_split, n_par);
+    std::cout << "Plano para n = " << n_par << ": " << plan.size() << " passos, custo " << plan_cost
+              << " (tabela: " << serial_cost << "), consistente: " << (consistent ? "sim" : "NAO")
+              << ", parentizacao com " << parens.size() << " caracteres" << std::endl;
+    std::cout << "---" << std::endl;
+
+    // --- Execução da cadeia: GEMM em blocos seguindo o plano ---
+    // Compara três formas de calcular o mesmo produto: laço triplo da
+    // esquerda para a direita, GEMM em blocos da esquerda para a direita
+    // (mesma ordem, kernel melhor) e GEMM em blocos seguindo o plano ótimo.
+    // Com "--bench", as cadeias grandes crescem.
+    std::cout << "Execucao da cadeia (threads = hardware_concurrency):" << std::endl;
+    auto runChain = [&](const char* label, const std::vector<int>& chain_dims, int repeats, auto zero) {
+        typedef decltype(zero) T; // double ou float
+        int chain_n = chain_dims.size() - 1;
+        std::uniform_real_distribution<T> value(-1.0, 1.0);
+        std::vector<DenseMatrix<T>> inputs(chain_n);
+        for (int a = 0; a < chain_n; a++) {
+            inputs[a].rows = chain_dims[a];
+            inputs[a].cols = chain_dims[a + 1];
+            inputs[a].data.resize((size_t)chain_dims[a] * chain_dims[a + 1]);
+            for (T& v : inputs[a].data) v = value(rng);
+        }
+        TriangularTable<int> chain_split;
+        matrixChainOrder(chain_dims, chain_split);
+        std::vector<MultiplyStep> optimal_plan = multiplyPlan(chain_split, chain_dims);
+        std::vector<MultiplyStep> left_plan;
+        for (int t = 0; t + 1 < chain_n; t++) {
+            left_plan.push_back({chain_n + t, t == 0 ? 0 : chain_n + t - 1, t + 1,
+                                 chain_dims[0], chain_dims[t + 1], chain_dims[t + 2]});
+        }
+        // O resultado da repetição anterior volta para o pool antes da próxima.
+        auto timeIt = [&](auto&& run, DenseMatrix<T>& out, BufferPool<T>* recycle) {
+            auto begin = std::chrono::steady_clock::now();
+            for (int r = 0; r < repeats; r++) {
+                if (recycle) recycle->release(std::move(out.data));
+                out = run();
+            }
+            auto end = std::chrono::steady_clock::now();
+            return std::chrono::duration<double, std::milli>(end - begin).count() / repeats;
+        };
+        BufferPool<T> left_pool, plan_pool;
+        DenseMatrix<T> naive, blocked, planned;
+        double naive_ms = timeIt([&] { return naiveChain(inputs); }, naive, nullptr);
+        double blocked_ms = timeIt([&] { return executeChain(left_plan, inputs, left_pool, 0); }, blocked, &left_pool);
+        double planned_ms = timeIt([&] { return executeChain(optimal_plan, inputs, plan_pool, 0); }, planned, &plan_pool);
+        int timed_allocations = plan_pool.allocations;
+        // Cada elemento de C faz as mesmas contas em qualquer divisão de
+        // linhas, então com 3 threads o resultado tem de ser igual bit a bit.
+        DenseMatrix<T> serial = executeChain(optimal_plan, inputs, plan_pool, 1);
+        bool threads_identical = executeChain(optimal_plan, inputs, plan_pool, 3).data == serial.data;
+        double max_diff = 0, max_value = 0; // Erro medido contra o laço triplo
+        for (size_t x = 0; x < naive.data.size(); x++) {
+            double reference = naive.data[x];
+            max_diff = std::max({max_diff, std::abs(reference - blocked.data[x]), std::abs(reference - planned.data[x])});
+            max_value = std::max(max_value, std::abs(reference));
+        }
+        std::cout << "\t" << label << ": ingenuo " << naive_ms << " ms, blocos esq.-dir. " << blocked_ms
+                  << " ms, blocos plano otimo " << planned_ms << " ms (speedup " << naive_ms / planned_ms
+                  << "x), erro relativo " << max_diff / std::max(max_value, 1e-300)
+                  << ", alocacoes do pool " << timed_allocations << " em " << repeats << " execucoes"
+                  << ", 1 e 3 threads identicos: " << (threads_identical ? "sim" : "NAO") << std::endl;
+    };
+    runChain("Cormen (6 matrizes)     ", dims, 2000, 0.0);
+    std::vector<int> dims_scaled;
+    for (int d : dims) dims_scaled.push_back(d * (bench ? 20 : 10));
+    runChain(bench ? "Cormen x20              " : "Cormen x10              ", dims_scaled, 1, 0.0);
+    std::vector<int> dims_random(bench ? 13 : 9);
+    for (int& d : dims_random) d = (bench ? 100 : 50) + rng() % (bench ? 900 : 350);
+    runChain(bench ? "aleatoria, 12 matrizes  " : "aleatoria, 8 matrizes   ", dims_random, 1, 0.0);
+    runChain("idem, float             ", dims_random, 1, 0.0f);
+    std::cout << "---" << std::endl;
+
+    // --- Escalonamento em grafo de tarefas ---
+    // No exemplo do Cormen, (A2A3) e (A4A5) não dependem um do outro.
+    // Sem ganho de tempo esperado com menos núcleos que threads: aqui só se confere a correção.
+    const int sched_threads = 4;
+    std::cout << "Grafo de tarefas do exemplo do Cormen, " << sched_threads << " threads ("
+              << std::thread::hardware_concurrency() << " nucleo(s) na maquina):" << std::endl;
+    std::vector<MultiplyStep> cormen_plan = multiplyPlan(s_table, dims);
+    std::vector<int> cormen_budget = planThreadBudget(cormen_plan, n_matrizes, sched_threads);
+    for (size_t t = 0; t < cormen_plan.size(); t++) {
+        const MultiplyStep& step = cormen_plan[t];
+        bool leaf = step.left < n_matrizes && step.right < n_matrizes;
+        std::cout << "\t" << step.result << " = " << step.left << " * " << step.right << ": "
+                  << cormen_budget[t] << " thread(s)" << (leaf ? ", pronto desde o inicio" : "") << std::endl;
+    }
+
+    TriangularTable<int> cp_split;
+    double cp_one = matrixChainCriticalPath(dims, 1, cp_split);
+    std::cout << "Caminho critico com 1 nucleo: " << cp_one << " (classico: " << min_cost << "), parentizacao "
+              << optimalParens(cp_split, n_matrizes) << std::endl;
+    // Resultado esperado: 15125 e ((A1(A2A3))((A4A5)A6))
+
+    // Cadeia aleatória: plano clássico vs plano de caminho crítico, no
+    // modelo e de verdade, com o executor em grafo de tarefas.
+    std::vector<int> dims_dag(bench ? 17 : 11);
+    for (int& d : dims_dag) d = (bench ? 100 : 40) + rng() % (bench ? 900 : 360);
+    int n_dag = dims_dag.size() - 1;
+    std::vector<DenseMatrix<double>> dag_inputs(n_dag);
+    std::uniform_real_distribution<double> dag_value(-1.0, 1.0);
+    for (int a = 0; a < n_dag; a++) {
+        dag_inputs[a].rows = dims_dag[a];
+        dag_inputs[a].cols = dims_dag[a + 1];
+        dag_inputs[a].data.resize((size_t)dims_dag[a] * dims_dag[a + 1]);
+        for (double& v : dag_inputs[a].data) v = dag_value(rng);
+    }
+    TriangularTable<int> classic_split;
+    matrixChainOrder(dims_dag, classic_split);
+    std::vector<MultiplyStep> classic_plan = multiplyPlan(classic_split, dims_dag);
+    std::cout << "Cadeia aleatoria de " << n_dag << " matrizes:" << std::endl;
+    for (int cores : {4, 16}) {
+        TriangularTable<int> cp_split_dag;
+        double cp_time = matrixChainCriticalPath(dims_dag, cores, cp_split_dag);
+        std::vector<MultiplyStep> cp_plan = multiplyPlan(cp_split_dag, dims_dag);
+        std::cout << "\tmodelo com " << cores << " nucleos: plano classico " << criticalPathTime(classic_plan, n_dag, cores)
+                  << ", plano de caminho critico " << cp_time << " (mult. por nucleo); total de mult. "
+                  << criticalPathTime(classic_plan, n_dag, 1) << " vs " << criticalPathTime(cp_plan, n_dag, 1) << std::endl;
+    }
+    TriangularTable<int> cp_split_dag;
+    matrixChainCriticalPath(dims_dag, sched_threads, cp_split_dag);
+    std::vector<MultiplyStep> cp_plan = multiplyPlan(cp_split_dag, dims_dag);
+    BufferPool<double> dag_pool;
+    DenseMatrix<double> reference = executeChain(classic_plan, dag_inputs, dag_pool, 1);
+    for (auto& named_plan : {std::make_pair("classico", &classic_plan), std::make_pair("caminho critico", &cp_plan)}) {
+        const std::vector<MultiplyStep>& chosen = *named_plan.second;
+        auto begin = std::chrono::steady_clock::now();
+        DenseMatrix<double> serial = executeChain(chosen, dag_inputs, dag_pool, 1);
+        auto middle = std::chrono::steady_clock::now();
+        DenseMatrix<double> parallel = executeChainParallel(chosen, dag_inputs, dag_pool, sched_threads);
+        auto end = std::chrono::steady_clock::now();
+        double serial_ms = std::chrono::duration<double, std::milli>(middle - begin).count();
+        double parallel_ms = std::chrono::duration<double, std::milli>(end - middle).count();
+        double max_diff = 0;
+        for (size_t x = 0; x < reference.data.size(); x++) {
+            max_diff = std::max(max_diff, std::abs(reference.data[x] - parallel.data[x]));
+        }
+        std::cout << "\tplano " << named_plan.first << ": serial " << serial_ms << " ms, grafo com "
+                  << sched_threads << " threads " << parallel_ms << " ms, igual ao serial bit a bit: "
+                  << (parallel.data == serial.data ? "sim" : "NAO") << ", diferenca max. para o plano classico "
+                  << max_diff << std::endl;
+    }
+    std::cout << "---" << std::endl;
+
+    // --- Hu-Shing, O(n log n) ---
+    // Conferido contra a DP: custo igual e plano consistente.
+    std::vector<MultiplyStep> hs_plan;
+    long long hs_cost = huShingOrder(dims, hs_plan);
+    bool same_plan = hs_plan.size() == cormen_plan.size();
+    for (size_t t = 0; same_plan && t < hs_plan.size(); t++) {
+        same_plan = hs_plan[t].left == cormen_plan[t].left && hs_plan[t].right == cormen_plan[t].right;
+    }
+    std::cout << "Hu-Shing no exemplo do Cormen: custo " << hs_cost << ", mesmo plano da DP: "
+              << (same_plan ? "sim" : "NAO") << std::endl;
+    // Resultado esperado: 15125, sim
+    int hs_checked = 0, hs_mismatches = 0;
+    for (int trial = 0; trial < 200; trial++) {
+        int n_check = trial < 195 ? 2 + rng() % 200 : 2000;
+        std::vector<int> dims_check(n_check + 1);
+        // Alguns casos com pesos repetidos, para exercitar os empates.
+        int max_dim = trial % 3 == 0 ? 3 : 50;
+        for (int& d : dims_check) d = 1 + rng() % max_dim;
+        long long expected = matrixChainOrder(dims_check);
+        long long got = huShingOrder(dims_check, hs_plan);
+        hs_checked++;
+        if (got != expected || (int)hs_plan.size() != n_check - 1) hs_mismatches++;
+    }
+    std::cout << "Hu-Shing vs DP em " << hs_checked << " cadeias (n ate 2000): " << hs_mismatches
+              << " diferencas" << std::endl;
+    int n_huge = 100000;
+    std::vector<int> dims_huge(n_huge + 1);
+    for (int& d : dims_huge) d = 1 + rng() % 1000;
+    start = std::chrono::steady_clock::now();
+    long long huge_cost = huShingOrder(dims_huge, hs_plan);
+    stop = std::chrono::steady_clock::now();
+    std::cout << "Hu-Shing, n = " << n_huge << ": custo " << huge_cost << ", " << hs_plan.size() << " passos, "
+              << std::chrono::duration<double, std::milli>(stop - start).count()
+              << " ms (a DP precisaria de " << 2.0 * n_huge * (n_huge + 1) / 2 * sizeof(int) / 1e9 << " GB)" << std::endl;
+    std::cout << "---" << std::endl;
+
+    // --- Aproximação de Chin, O(n) ---
+    std::vector<MultiplyStep> chin_plan;
+    std::cout << "Chin no exemplo do Cormen: custo " << chinOrder(dims, chin_plan) << std::endl;
+    // Resultado esperado: 15125 (aqui a aproximação acerta o ótimo)
+    // O teste de corte é homogêneo: multiplicar todas as dimensões por 2*10^7
+    // (até ~2*10^9, perto de INT_MAX) não pode mudar o plano.
+    std::vector<int> dims_small(41), dims_large(41);
+    for (size_t v = 0; v < dims_small.size(); v++) {
+        dims_small[v] = 1 + rng() % 100;
+        dims_large[v] = dims_small[v] * 20000000;
+    }
+    std::vector<MultiplyStep> small_plan, big_plan;
+    chinOrder(dims_small, small_plan);
+    chinOrder(dims_large, big_plan);
+    bool same_scaled = small_plan.size() == big_plan.size();
+    for (size_t t = 0; same_scaled && t < small_plan.size(); t++) {
+        same_scaled = small_plan[t].left == big_plan[t].left && small_plan[t].right == big_plan[t].right;
+    }
+    std::cout << "Chin com dimensoes x 2*10^7: mesmo plano: " << (same_scaled ? "sim" : "NAO") << std::endl;
+    double worst_ratio = 1, ratio_sum = 0;
+    int ratio_count = 0;
+    for (int trial = 0; trial < 2000; trial++) {
+        int n_check = 2 + rng() % 60;
+        std::vector<int> dims_check(n_check + 1);
+        int max_dim = trial % 2 == 0 ? 5 : 100;
+        for (int& d : dims_check) d = 1 + rng() % max_dim;
+        double ratio = (double)chinOrder(dims_check, chin_plan) / matrixChainOrder(dims_check);
+        worst_ratio = std::max(worst_ratio, ratio);
+        ratio_sum += ratio;
+        ratio_count++;
+    }
+    std::cout << "Chin / otimo em " << ratio_count << " cadeias: medio " << ratio_sum / ratio_count << ", pior "
+              << worst_ratio << " (limite 1.25): " << (worst_ratio <= 1.25 ? "ok" : "FALHOU") << std::endl;
+    for (int n_online : {100, 1000, n_huge}) {
+        std::vector<int> dims_online(dims_huge.begin(), dims_huge.begin() + n_online + 1);
+        int repeats = std::max(1, 200000 / n_online);
+        start = std::chrono::steady_clock::now();
+        long long chin_cost = 0;
+        for (int r = 0; r < repeats; r++) chin_cost = chinOrder(dims_online, chin_plan);
+        stop = std::chrono::steady_clock::now();
+        long long exact_cost = huShingOrder(dims_online, hs_plan);
+        std::cout << "\tn = " << n_online << ": Chin "
+                  << std::chrono::duration<double, std::micro>(stop - start).count() / repeats << " us, custo "
+                  << (double)chin_cost / exact_cost << "x o otimo" << std::endl;
+    }
+    std::vector<MultiplyStep> planned_steps;
+    for (int n_plan : {50, EXACT_CHAIN_LIMIT + 1}) {
+        std::vector<int> dims_plan(dims_par.begin(), dims_par.begin() + n_plan + 1); // Dimensões 1 a 10
+        long long planned = planMatrixChain(dims_plan, planned_steps);
+        std::cout << "Planejador, n = " << n_plan << " (" << (n_plan <= EXACT_CHAIN_LIMIT ? "exato" : "Chin")
+                  << "): custo " << planned << ", otimo " << huShingOrder(dims_plan, hs_plan) << std::endl;
+    }
+    std::cout << "---" << std::endl;
+
+    // --- Memória dos intermediários: limite e fronteira de Pareto ---
+    // No exemplo do Cormen o plano mais barato já é o de menor pico: a
+    // fronteira tem um ponto só. Na segunda cadeia, economizar memória custa
+    // multiplicações. Os picos são do modelo de planPeakBytes (bytes vivos),
+    // não a memória que o BufferPool retém.
+    std::vector<int> dims_memory = {786, 697, 639, 290, 987, 630, 353};
+    for (const std::vector<int>* chain_dims : {&dims, &dims_memory}) {
+        std::cout << "Fronteira (multiplicacoes, pico de bytes), p =";
+        for (int d : *chain_dims) std::cout << " " << d;
+        std::cout << ":" << std::endl;
+        for (const MemoryAwareCost& point : matrixChainParetoFront(*chain_dims)) {
+            std::cout << "\t" << point.flops << " mult., " << point.peak_bytes << " bytes" << std::endl;
+        }
+    }
+    // Conferência com a fronteira exata, por força bruta em cadeias curtas:
+    // cada célula guarda todos os pares (multiplicações, pico) não dominados.
+    auto exactFront = [](const std::vector<int>& chain_dims) {
+        int chain_n = chain_dims.size() - 1;
+        typedef std::vector<std::pair<long long, long long>> Pairs;
+        std::vector<std::vector<Pairs>> cell(chain_n + 2, std::vector<Pairs>(chain_n + 2));
+        auto bytesOf = [&](int i, int j) {
+            return i == j ? 0LL : (long long)chain_dims[i - 1] * chain_dims[j] * (long long)sizeof(double);
+        };
+        for (int i = 1; i <= chain_n; i++) cell[i][i] = {{0, 0}};
+        for (int L = 2; L <= chain_n; L++) {
+            for (int i = 1; i <= chain_n - L + 1; i++) {
+                int j = i + L - 1;
+                Pairs all;
+                for (int k = i; k < j; k++) {
+                    long long own = (long long)chain_dims[i - 1] * chain_dims[k] * chain_dims[j];
+                    for (const auto& left : cell[i][k]) {
+                        for (const auto& right : cell[k + 1][j]) {
+                            all.push_back({left.first + right.first + own,
+                                           std::max({left.second, bytesOf(i, k) + right.second,
+                                                     bytesOf(i, k) + bytesOf(k + 1, j) + bytesOf(i, j)})});
+                        }
+                    }
+                }
+                std::sort(all.begin(), all.end());
+                for (const auto& candidate : all) {
+                    if (cell[i][j].empty() || candidate.second < cell[i][j].back().second) cell[i][j].push_back(candidate);
+                }
+            }
+        }
+        return cell[1][chain_n];
+    };
+    // Limites nos picos da fronteira, logo abaixo deles e no meio entre dois
+    // pontos: é no meio que a heurística de dois candidatos pode errar.
+    int cap_checks = 0, cap_exact = 0, cap_infeasible_wrong = 0, plan_mismatches = 0;
+    double worst_cap_ratio = 1;
+    for (int trial = 0; trial < 2000; trial++) {
+        int n_check = 3 + rng() % 10;
+        std::vector<int> dims_check(n_check + 1);
+        int max_dim = trial % 2 == 0 ? 20 : 1000;
+        for (int& d : dims_check) d = 1 + rng() % max_dim;
+        auto front = exactFront(dims_check);
+        for (size_t f = 0; f < front.size(); f++) {
+            long long between = f + 1 < front.size() ? (front[f].second + front[f + 1].second) / 2 : front[f].second;
+            for (long long cap : {front[f].second, front[f].second - 1, between}) {
+                long long exact_flops = -1; // Menos multiplicações com pico <= cap (-1 = inviável)
+                for (const auto& point : front) {
+                    if (point.second <= cap) {
+                        exact_flops = point.first;
+                        break;
+                    }
+                }
+                TriangularTable<int> mem_split;
+                MemoryAwareCost got = matrixChainMemoryCapped(dims_check, cap, mem_split);
+                std::vector<MultiplyStep> mem_plan = multiplyPlan(mem_split, dims_check);
+                long long plan_flops = 0;
+                for (const MultiplyStep& step : mem_plan) plan_flops += (long long)step.rows * step.inner * step.cols;
+                if (plan_flops != got.flops || planPeakBytes(mem_plan, n_check) != got.peak_bytes) plan_mismatches++;
+                cap_checks++;
+                if (got.within_cap != (exact_flops >= 0)) {
+                    cap_infeasible_wrong++;
+                } else if (exact_flops >= 0) {
+                    if (got.flops == exact_flops) cap_exact++;
+                    worst_cap_ratio = std::max(worst_cap_ratio, (double)got.flops / exact_flops);
+                } else {
+                    cap_exact++;
+                }
+            }
+        }
+    }
+    std::cout << "Limite de memoria (heuristica) vs forca bruta (n <= 12): " << cap_exact << " de " << cap_checks
+              << " limites com o otimo exato, pior razao " << worst_cap_ratio << ", viabilidade errada "
+              << cap_infeasible_wrong << ", plano diferente do previsto " << plan_mismatches << std::endl;
+    // Esperado: viabilidade e plano sempre certos; alguns limites fora do ótimo (razão de poucos por cento).
+    int n_mem = bench ? 500 : 150;
+    std::vector<int> dims_mem(dims_huge.begin(), dims_huge.begin() + n_mem + 1); // Dimensões 1 a 1000
+    start = std::chrono::steady_clock::now();
+    auto mem_front = matrixChainParetoFront(dims_mem, 8);
+    stop = std::chrono::steady_clock::now();
+    std::cout << "Fronteira para n = " << n_mem << " (" << mem_front.size() << " pontos, "
+              << std::chrono::duration<double, std::milli>(stop - start).count() << " ms):" << std::endl;
+    for (const MemoryAwareCost& point : mem_front) {
+        std::cout << "\t" << point.flops << " mult., " << point.peak_bytes / 1e6 << " MB" << std::endl;
+    }
+    for (double fraction : {1.0, 0.9}) {
+        long long cap = (long long)(mem_front[0].peak_bytes * fraction);
+        TriangularTable<int> mem_split;
+        MemoryAwareCost capped = matrixChainMemoryCapped(dims_mem, cap, mem_split);
+        std::cout << "\tlimite de " << cap / 1e6 << " MB: " << (capped.within_cap ? "" : "impossivel; menor pico: ")
+                  << capped.flops << " mult., " << capped.peak_bytes / 1e6 << " MB" << std::endl;
+    }
+    std::cout << "---" << std::endl;
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,380 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <limits>    // Para std::numeric_limits
+#include <iomanip>   // Para std::setprecision
+#include <algorithm> // Para std::min, std::shuffle
+#include <cstdint>   // Para int32_t
+#include <cmath>     // Para std::pow
+#include <random>    // Para as instâncias de teste
+#include <chrono>    // Para medir as buscas
+#include <stdexcept> // Para std::invalid_argument
+#if defined(__SSE2__)
+#include <emmintrin.h> // Busca dentro do nó com SSE2
+#endif
+
+/**
+ * @brief Tabelas da DP da árvore de busca k-ária ótima.
+ *
+ * Cada nó guarda de 1 a k-1 chaves (uma cache line) e o custo de uma busca é
+ * o número de nós visitados. Para as chaves i..j (fictícias d_{i-1}..d_j):
+ *
+ * e(i, i-1) = 0 (ponteiro nulo: nenhum nó a mais)
+ * e(i, j)   = w(i, j) + min_r { e(i, r-1) + H_{k-2}(r+1, j) }
+ *
+ * onde r é a primeira chave do nó e H_t(a, j) é o menor custo de cobrir
+ * a..j com até t chaves a mais no mesmo nó:
+ *
+ * H_0(a, j) = e(a, j)
+ * H_t(a, j) = min( H_{t-1}(a, j), min_r { e(a, r-1) + H_{t-1}(r+1, j) } )
+ *
+ * Com k = 2 é a árvore binária ótima, medida em nós visitados
+ * (e do Cormen menos a soma dos q).
+ */
+struct MultiwayTables {
+    int n, k;
+    std::vector<double> e;                // e[i * (n + 2) + j]
+    std::vector<int> first_key;           // Primeira chave do nó ótimo de [i, j]
+    std::vector<std::vector<double>> H;   // H[t][a * (n + 2) + j], t = 1..k-2
+    std::vector<std::vector<int>> H_key;  // Chave escolhida em H_t (0 = não usa chave)
+
+    size_t at(int i, int j) const { return (size_t)i * (n + 2) + j; }
+    double cover(int t, int a, int j) const { return t == 0 ? e[at(a, j)] : H[t][at(a, j)]; }
+};
+
+/**
+ * @brief DP da árvore k-ária (nós com até k-1 chaves).
+ *
+ * Por padrão (window_slack < 0) a busca por r percorre todo [i, j]: é a DP
+ * exata, O(k·n^3). Não há aceleração exata: as raízes não são monótonas
+ * para k >= 3 (em testes aleatórios ~6% das células violam a monotonia), e
+ * nenhum limite que valha para nós k-ários foi encontrado.
+ *
+ * Com window_slack >= 0 (opcional), r só é buscado entre as escolhas de
+ * [i, j-1] e [i+1, j] na mesma tabela, alargadas por window_slack posições
+ * de cada lado. O custo cai para perto de O(k·n^2), mas para k >= 3 isso é
+ * uma heurística: nos testes a diferença para a ótima chegou a ~1.8%. Só
+ * com k = 2 (árvore binária, raízes monótonas) a janela é exata.
+ * verifyMultiwayTree mede a diferença contra a DP exata.
+ *
+ * @param p Probabilidades das chaves (p[1..n]).
+ * @param q Probabilidades das fictícias (q[0..n]).
+ * @param n Número de chaves.
+ * @param k Grau máximo (cada nó tem até k-1 chaves), k >= 2.
+ * @param T Tabelas preenchidas (saída).
+ * @param window_slack Folga da janela heurística; < 0 (padrão) = DP exata.
+ * @throws std::invalid_argument Se k < 2.
+ */
+void optimalMultiwayTree(const std::vector<double>& p, const std::vector<double>& q,
+                         int n, int k, MultiwayTables& T, int window_slack = -1) {
+
+    if (k < 2) {
+        throw std::invalid_argument("k deve ser >= 2 (cada no tem ate k-1 chaves)");
+    }
+
+    T.n = n;
+    T.k = k;
+    size_t cells = (size_t)(n + 2) * (n + 2);
+    T.e.assign(cells, 0.0);
+    T.first_key.assign(cells, 0);
+    T.H.assign(std::max(k - 1, 1), {});
+    T.H_key.assign(std::max(k - 1, 1), {});
+    for (int t = 1; t <= k - 2; ++t) {
+        T.H[t].assign(cells, 0.0);
+        T.H_key[t].assign(cells, 0);
+    }
+
+    // Somas de prefixo: w(i, j) = W[j] - W[i-1] + q[i-1].
+    std::vector<double> W(n + 1);
+    W[0] = q[0];
+    for (int i = 1; i <= n; ++i) W[i] = W[i - 1] + p[i] + q[i];
+
+    // Casos base (l = 0): e = H_t = 0, já preenchidos.
+    for (int l = 1; l <= n; ++l) {
+        for (int i = 1; i + l - 1 <= n; ++i) {
+            int j = i + l - 1;
+            size_t cell = T.at(i, j);
+
+            // --- e(i, j): escolhe a primeira chave r do nó ---
+            int lo = i, hi = j;
+            if (window_slack >= 0 && l > 1) {
+                int left = T.first_key[T.at(i, j - 1)], right = T.first_key[T.at(i + 1, j)];
+                lo = std::max(i, std::min(left, right) - window_slack);
+                hi = std::min(j, std::max(left, right) + window_slack);
+            }
+            double best = std::numeric_limits<double>::max();
+            int best_r = lo;
+            for (int r = lo; r <= hi; ++r) {
+                double cost = T.e[T.at(i, r - 1)] + T.cover(k - 2, r + 1, j);
+                if (cost < best) {
+                    best = cost;
+                    best_r = r;
+                }
+            }
+            T.e[cell] = W[j] - W[i - 1] + q[i - 1] + best;
+            T.first_key[cell] = best_r;
+
+            // --- H_t(i, j), t = 1..k-2: mais uma chave opcional no mesmo nó ---
+            for (int t = 1; t <= k - 2; ++t) {
+                int h_lo = i, h_hi = j;
+                if (window_slack >= 0 && l > 1) {
+                    // Só usa a janela quando as duas vizinhas escolheram uma chave.
+                    int left = T.H_key[t][T.at(i, j - 1)], right = T.H_key[t][T.at(i + 1, j)];
+                    if (left > 0 && right > 0) {
+                        h_lo = std::max(i, std::min(left, right) - window_slack);
+                        h_hi = std::min(j, std::max(left, right) + window_slack);
+                    }
+                }
+                double h_best = T.cover(t - 1, i, j);
+                int h_r = 0;
+                for (int r = h_lo; r <= h_hi; ++r) {
+                    double cost = T.e[T.at(i, r - 1)] + T.cover(t - 1, r + 1, j);
+                    if (cost < h_best) {
+                        h_best = cost;
+                        h_r = r;
+                    }
+                }
+                T.H[t][cell] = h_best;
+                T.H_key[t][cell] = h_r;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Modo de verificação: DP com janela heurística vs DP exata.
+ * @return double (custo da janela - custo exato) / custo exato, em e(1, n).
+ */
+double verifyMultiwayTree(const std::vector<double>& p, const std::vector<double>& q,
+                          int n, int k, int window_slack) {
+    MultiwayTables fast, full;
+    optimalMultiwayTree(p, q, n, k, fast, window_slack);
+    optimalMultiwayTree(p, q, n, k, full, -1);
+    double a = fast.e[fast.at(1, n)], b = full.e[full.at(1, n)];
+    return (a - b) / std::max(b, 1e-300);
+}
+
+// Chaves por nó materializado: 12 chaves de 32 bits + cabeçalho = 64 bytes.
+const int NODE_KEYS = 12;
+
+/**
+ * @brief Nó de 64 bytes (uma cache line) com até NODE_KEYS chaves de 32 bits.
+ *
+ * Chaves não usadas valem INT32_MAX, então "quantas chaves < x" já é o índice
+ * do filho. Os filhos não nulos ficam contíguos a partir de first_child;
+ * child_mask diz quais das count+1 posições têm filho.
+ */
+struct alignas(64) MultiwayNode {
+    int32_t keys[NODE_KEYS];
+    int32_t first_child;
+    uint16_t child_mask;
+    uint16_t count;
+    int32_t padding[2];
+};
+
+/**
+ * @brief Árvore k-ária materializada (k <= 13), com nós em ordem de nível.
+ */
+struct MultiwayTree {
+    std::vector<MultiwayNode> nodes;
+
+    /**
+     * Busca x. Devolve true se achou; 'touched' recebe os nós visitados.
+     */
+    bool lookup(int32_t x, int& touched) const {
+        touched = 0;
+        if (nodes.empty()) return false;
+        int t = 0;
+        while (true) {
+            const MultiwayNode& node = nodes[t];
+            touched++;
+#if defined(__SSE2__)
+            // Compara x com as NODE_KEYS = 12 chaves em 3 registradores; cada chave < x vira um bit.
+            __m128i needle = _mm_set1_epi32(x);
+            int less = 0;
+            for (int g = 0; g < 3; ++g) {
+                __m128i block = _mm_load_si128((const __m128i*)(node.keys + 4 * g));
+                less |= _mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(block, needle))) << (4 * g);
+            }
+            int slot = __builtin_popcount(less);
+#else
+            int slot = 0;
+            while (slot < node.count && node.keys[slot] < x) slot++;
+#endif
+            if (slot < node.count && node.keys[slot] == x) return true;
+            if (!((node.child_mask >> slot) & 1)) return false;
+            t = node.first_child + __builtin_popcount(node.child_mask & ((1u << slot) - 1));
+        }
+    }
+};
+
+/**
+ * @brief Monta a árvore k-ária a partir das tabelas (busca em largura).
+ *
+ * @param key_values key_values[r] = valor (32 bits, crescente) da chave k_r.
+ * @throws std::invalid_argument Se T.k > NODE_KEYS + 1 (o nó não comporta k-1 chaves).
+ */
+MultiwayTree buildMultiwayTree(const MultiwayTables& T, const std::vector<int32_t>& key_values) {
+    if (T.k < 2 || T.k > NODE_KEYS + 1) {
+        throw std::invalid_argument("buildMultiwayTree exige 2 <= k <= " + std::to_string(NODE_KEYS + 1));
+    }
+    MultiwayTree tree;
+    if (T.n == 0) return tree;
+
+    // Fila de intervalos [i, j] não vazios; o nó de índice x vem do x-ésimo da fila.
+    std::vector<std::pair<int, int>> queue = {{1, T.n}};
+    for (size_t head = 0; head < queue.size(); ++head) {
+        int i = queue[head].first, j = queue[head].second;
+        MultiwayNode node;
+        std::fill(node.keys, node.keys + NODE_KEYS, std::numeric_limits<int32_t>::max());
+        node.count = 0;
+        node.child_mask = 0;
+        node.padding[0] = node.padding[1] = 0;
+        node.first_child = queue.size();
+
+        // Chaves do nó: a primeira vem de e, as demais seguindo H_{k-2}, H_{k-3}, ...
+        auto addChild = [&](int a, int b) {
+            if (a <= b) {
+                node.child_mask |= 1u << node.count;
+                queue.push_back({a, b});
+            }
+        };
+        int r = T.first_key[T.at(i, j)];
+        addChild(i, r - 1);
+        node.keys[node.count++] = key_values[r];
+        int a = r + 1, t = T.k - 2;
+        while (t > 0 && a <= j) {
+            int next = T.H_key[t][T.at(a, j)];
+            if (next > 0) {
+                addChild(a, next - 1);
+                node.keys[node.count++] = key_values[next];
+                a = next + 1;
+            }
+            t--;
+        }
+        addChild(a, j);
+        tree.nodes.push_back(node);
+    }
+    return tree;
+}
+
+/**
+ * @brief Normaliza p e q para somarem 1.
+ */
+void normalize(std::vector<double>& p, std::vector<double>& q) {
+    double total = 0.0;
+    for (size_t i = 1; i < p.size(); ++i) total += p[i];
+    for (double x : q) total += x;
+    for (size_t i = 1; i < p.size(); ++i) p[i] /= total;
+    for (double& x : q) x /= total;
+}
+
+// Main para teste
+int main() {
+    std::cout << "---" << std::endl;
+    std::cout << "Algoritmo: Arvore de Busca k-aria Otima (nos de uma cache line)" << std::endl;
+    std::cout << "Generalizacao do OPTIMAL-BST (Cormen 15.5) para nos com ate k-1 chaves" << std::endl;
+    std::cout << "---" << std::endl;
+
+    // --- Teste 1: Exemplo do livro ---
+    // Com k = 2 o custo é o e[1][5] = 2.75 do Cormen menos sum q = 0.40.
+    int n = 5;
+    std::vector<double> p = {0.0, 0.15, 0.10, 0.05, 0.10, 0.20};
+    std::vector<double> q = {0.05, 0.10, 0.05, 0.05, 0.05, 0.10};
+    std::cout << "--- Teste 1: Exemplo do livro (n=5) ---" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    for (int k : {2, 3, 4, 6}) {
+        MultiwayTables T;
+        optimalMultiwayTree(p, q, n, k, T);
+        std::cout << "k = " << k << ": nos visitados esperados = " << T.e[T.at(1, n)] << std::endl;
+        // Esperado: 2.35 (k=2), e 1.00 para k=6 (todas as chaves num só nó)
+    }
+    std::cout << "---" << std::endl;
+
+    // --- Teste 2: Verificação da janela heurística ---
+    std::cout << "--- Teste 2: Janela heuristica vs DP exata ---" << std::endl;
+    std::mt19937 rng(99);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    double worst = 0.0, worst_binary = 0.0;
+    const int slack = 2;
+    for (int trial = 0; trial < 40; ++trial) {
+        int m = 1 + rng() % 120;
+        std::vector<double> pr(m + 1, 0.0), qr(m + 1);
+        for (int i = 1; i <= m; ++i) pr[i] = trial % 2 ? uniform(rng) : std::pow(uniform(rng), 6);
+        for (double& x : qr) x = trial % 3 ? uniform(rng) : 0.0;
+        normalize(pr, qr);
+        worst_binary = std::max(worst_binary, verifyMultiwayTree(pr, qr, m, 2, slack));
+        for (int k : {3, 5, 13}) {
+            worst = std::max(worst, verifyMultiwayTree(pr, qr, m, k, slack));
+        }
+    }
+    std::cout << std::scientific << std::setprecision(2);
+    std::cout << "40 instancias, k = 2: maior diferenca relativa = " << worst_binary << std::endl; // Esperado: 0 (raizes monotonas)
+    std::cout << "40 instancias, k em {3, 5, 13}: maior diferenca relativa = " << worst
+              << " (heuristica: raizes nao monotonas para k >= 3)" << std::endl;
+    std::cout << "---" << std::endl;
+
+    // --- Teste 3: Cache lines por busca, binária vs 13-ária ---
+    // DP exata (O(k·n^3)): com n = 1000 e k = 13 ela leva ~20 s, então usamos n = 400.
+    std::cout << "--- Teste 3: Nos (cache lines) por busca ---" << std::endl;
+    int n3 = 400;
+    std::vector<double> p3(n3 + 1, 0.0), q3(n3 + 1);
+    for (int i = 1; i <= n3; ++i) p3[i] = 1.0 / (1 + rng() % 1000);
+    for (double& x : q3) x = 0.2 / (1 + rng() % 1000);
+    normalize(p3, q3);
+
+    std::vector<int32_t> key_values(n3 + 1);
+    for (int r = 1; r <= n3; ++r) key_values[r] = 2 * r;
+
+    // Consultas pela própria distribuição: k_r -> 2r, d_g -> 2g + 1.
+    std::vector<double> cumulative(2 * n3 + 1);
+    double acc = 0.0;
+    for (int t = 0; t <= 2 * n3; ++t) {
+        acc += (t % 2 == 0) ? q3[t / 2] : p3[(t + 1) / 2];
+        cumulative[t] = acc;
+    }
+    std::vector<int32_t> queries(2000000);
+    for (int32_t& x : queries) {
+        int t = std::lower_bound(cumulative.begin(), cumulative.end(), uniform(rng) * acc) - cumulative.begin();
+        x = std::min(t, 2 * n3) + 1;
+    }
+
+    std::cout << std::fixed << std::setprecision(3);
+    for (int k : {2, 13}) {
+        MultiwayTables T;
+        auto t0 = std::chrono::steady_clock::now();
+        optimalMultiwayTree(p3, q3, n3, k, T);
+        auto t1 = std::chrono::steady_clock::now();
+        MultiwayTree tree = buildMultiwayTree(T, key_values);
+
+        long long touched_total = 0, found = 0;
+        auto t2 = std::chrono::steady_clock::now();
+        for (int32_t x : queries) {
+            int touched;
+            found += tree.lookup(x, touched);
+            touched_total += touched;
+        }
+        auto t3 = std::chrono::steady_clock::now();
+        std::cout << "k = " << std::setw(2) << k << ": esperado " << T.e[T.at(1, n3)]
+                  << " nos/busca, medido " << (double)touched_total / queries.size()
+                  << " | " << tree.nodes.size() << " nos de 64 bytes"
+                  << " | DP " << std::chrono::duration<double, std::milli>(t1 - t0).count() << " ms"
+                  << " | " << std::chrono::duration<double, std::nano>(t3 - t2).count() / queries.size()
+                  << " ns/busca (" << found << " achadas)" << std::endl;
+    }
+    std::cout << "---" << std::endl;
+
+    // --- Teste 4: k fora do suportado pelo nó de 64 bytes ---
+    std::cout << "--- Teste 4: k = 14 (nao cabe em um no) ---" << std::endl;
+    try {
+        MultiwayTables T;
+        optimalMultiwayTree(p, q, n, 14, T);
+        buildMultiwayTree(T, {0, 1, 2, 3, 4, 5});
+        std::cout << "Erro: k = 14 deveria ser rejeitado" << std::endl;
+    } catch (const std::invalid_argument& error) {
+        std::cout << "Rejeitado: " << error.what() << std::endl; // Esperado
+    }
+    std::cout << "---" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,82 @@
+#ifndef PERF_COUNTER_H
+#define PERF_COUNTER_H
+
+#include <cstdint>
+#include <cstring> // Para std::memset
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Contador de hardware do Linux (perf_event_open) só para o próprio processo.
+ *
+ * Mede eventos em modo usuário entre start() e stop(). Em máquinas virtuais
+ * ou sem permissão o contador não abre; aí available() é falso e stop()
+ * devolve -1, e quem chama imprime "n/d".
+ */
+struct PerfCounter {
+    enum Event {
+        CACHE_MISSES,    // Faltas no último nível de cache
+        L1D_READ_MISSES  // Faltas de leitura no cache L1 de dados
+    };
+
+    int fd = -1;
+
+    explicit PerfCounter(Event event) {
+#if defined(__linux__)
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        if (event == CACHE_MISSES) {
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        } else {
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                          (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        }
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#else
+        (void)event;
+#endif
+    }
+
+    ~PerfCounter() {
+#if defined(__linux__)
+        if (fd >= 0) close(fd);
+#endif
+    }
+
+    PerfCounter(const PerfCounter&) = delete;
+    PerfCounter& operator=(const PerfCounter&) = delete;
+
+    bool available() const { return fd >= 0; }
+
+    void start() {
+#if defined(__linux__)
+        if (fd < 0) return;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+
+    long long stop() {
+#if defined(__linux__)
+        if (fd < 0) return -1;
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        long long count = 0;
+        if (read(fd, &count, sizeof(count)) != (ssize_t)sizeof(count)) return -1;
+        return count;
+#else
+        return -1;
+#endif
+    }
+};
+
+#endif // PERF_COUNTER_H
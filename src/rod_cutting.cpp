@@ -1,7 +1,13 @@
 #include <iostream> 
 #include <vector>   
 #include <algorithm> // Para std::max
-#include <climits>   // Para INT_MIN (o menor valor inteiro possível)
+#include <climits>   // Para INT_MIN (o menor valor inteiro possível) e LLONG_MIN
+#include <utility>   // Para std::pair
+#include <chrono>    // Para comparar os caminhos rápidos com o cutRod
+#include <thread>    // Para distribuir os blocos de cenários
+#include <atomic>
+#include <stdexcept> // Para std::invalid_argument
+#include <string>
 
 /**
  * @brief Soluciona o Problema do Corte de Barras (Rod Cutting) 
@@ -58,6 +64,650 @@ int cutRod(const std::vector<int>& prices, int n) {
     return val[n];
 }
 
+/**
+ * @brief Tenta resolver o corte de barras para um 'n' enorme explorando a
+ * periodicidade da solução ótima.
+ *
+ * Seja k o pedaço de maior densidade (prices[k-1] / k). Sempre vale
+ * val[j + k] >= val[j] + p_k. Se a igualdade valer para 'm' comprimentos
+ * consecutivos, ela vale para todos os seguintes (por indução na recorrência,
+ * que só olha 'm' posições para trás). A partir daí:
+ * val[N] = val[x0] + ((N - x0) / k) * p_k, com x0 ≡ N (mod k) na janela.
+ *
+ * Pelo argumento da casa dos pombos, existe solução ótima com menos de k
+ * pedaços "não-ótimos", então o regime periódico começa antes de k*m.
+ * Só usamos memória O(m): um buffer circular com os últimos m+1 valores.
+ *
+ * @param prices Preços (mesmo formato de cutRod).
+ * @param n Comprimento da barra (pode chegar a 10^12 ou mais).
+ * @param scan_limit Maior comprimento que aceitamos varrer procurando o regime periódico.
+ * @param result Recebe o lucro máximo, se a função retornar true.
+ * @return bool true se o regime periódico foi encontrado (ou n <= scan_limit).
+ */
+bool cutRodPeriodic(const std::vector<int>& prices, long long n,
+                    long long scan_limit, long long& result) {
+
+    int m = prices.size();
+    if (m == 0 || n <= 0) {
+        result = 0;
+        return true;
+    }
+
+    // --- Passo 1: Pedaço de maior densidade ---
+    // Comparamos p_i / i com p_k / k por multiplicação cruzada (sem ponto flutuante).
+    int k = 1;
+    for (int i = 2; i <= m; i++) {
+        if ((long long)prices[i - 1] * k > (long long)prices[k - 1] * i) {
+            k = i;
+        }
+    }
+    long long pk = prices[k - 1];
+
+    // --- Passo 2: DP em buffer circular até achar 'm' igualdades seguidas ---
+    // ring[j % R] guarda val[j]; R = m+1 basta, pois só olhamos até m para trás.
+    int R = m + 1;
+    std::vector<long long> ring(R);
+    ring[0] = 0;
+    int streak = 0; // quantos j seguidos satisfazem val[j] == val[j-k] + p_k
+
+    long long last = std::min(n, scan_limit);
+    for (long long j = 1; j <= last; j++) {
+        long long best = LLONG_MIN;
+        for (int i = 1; i <= m && i <= j; i++) {
+            best = std::max(best, prices[i - 1] + ring[(j - i) % R]);
+        }
+        ring[j % R] = best;
+
+        if (j >= k && best == ring[(j - k) % R] + pk) {
+            streak++;
+        } else {
+            streak = 0;
+        }
+
+        // Regime periódico confirmado: val[x + k] = val[x] + p_k para todo x >= j - k - m + 1.
+        if (streak >= m && j < n) {
+            // x0 é o comprimento em [j-k+1, j] congruente a n (mod k).
+            long long first = j - k + 1;
+            long long x0 = first + (n - first) % k;
+            result = ring[x0 % R] + ((n - x0) / k) * pk;
+            return true;
+        }
+    }
+
+    if (last == n) {
+        result = ring[n % R];
+        return true;
+    }
+    return false; // Não detectamos o período dentro do orçamento.
+}
+
+/**
+ * @brief Corte de barras para 'n' enorme por duplicação (estilo Kitamasa no semi-anel (max,+)).
+ *
+ * Usa a identidade val[a + b] = max_{t} val[t] + val[a + b - t], com t numa janela
+ * de 'm' comprimentos consecutivos (toda partição tem uma soma de prefixo em
+ * qualquer janela de largura m). Guardamos apenas o bloco
+ * B(x) = val[x-m+1 .. x+m-1] e sabemos ir de B(x) para B(2x) em O(m²)
+ * e de B(x) para B(x+1) em O(m). Percorrendo os bits de n, o custo total
+ * é O(m² log n) com memória O(m).
+ *
+ * @param prices Preços (mesmo formato de cutRod).
+ * @param n Comprimento da barra.
+ * @return long long O lucro máximo (supõe que cabe em long long).
+ */
+long long cutRodDoubling(const std::vector<int>& prices, long long n) {
+
+    int m = prices.size();
+    if (m == 0 || n <= 0) {
+        return 0;
+    }
+
+    // --- Passo 1: Escolhe o ponto de partida x0 (bits mais altos de n) ---
+    // Precisamos de x0 >= m-1 para que o bloco não tenha índices negativos.
+    int shift = 0;
+    while ((n >> (shift + 1)) >= 2LL * m) {
+        shift++;
+    }
+    long long x = n >> shift;
+
+    // --- Passo 2: DP direto até x + m - 1 (tamanho O(m)) ---
+    std::vector<long long> val(x + m);
+    val[0] = 0;
+    for (long long j = 1; j < x + m; j++) {
+        long long best = LLONG_MIN;
+        for (int i = 1; i <= m && i <= j; i++) {
+            best = std::max(best, prices[i - 1] + val[j - i]);
+        }
+        val[j] = best;
+    }
+    if (shift == 0) {
+        return val[n];
+    }
+
+    // B[d + m - 1] = val[x + d], para d em [-(m-1), m-1].
+    int width = 2 * m - 1;
+    std::vector<long long> B(val.begin() + (x - m + 1), val.begin() + (x + m));
+    std::vector<long long> next(width);
+
+    // --- Passo 3: Percorre os bits restantes de n (do mais alto para o mais baixo) ---
+    for (int bit = shift - 1; bit >= 0; bit--) {
+
+        // Duplicação: val[2x + d] = max_{a+b=d} val[x+a] + val[x+b].
+        for (int d = -(m - 1); d <= m - 1; d++) {
+            long long best = LLONG_MIN;
+            int lo = std::max(-(m - 1), d - (m - 1));
+            int hi = std::min(m - 1, d + (m - 1));
+            for (int a = lo; a <= hi; a++) {
+                best = std::max(best, B[a + m - 1] + B[d - a + m - 1]);
+            }
+            next[d + m - 1] = best;
+        }
+        B.swap(next);
+        x *= 2;
+
+        // Se o bit está ligado, andamos um passo: B(x) -> B(x+1).
+        if ((n >> bit) & 1) {
+            // val[x + m] = max_i p_i + val[x + m - i], que está dentro do bloco.
+            long long best = LLONG_MIN;
+            for (int i = 1; i <= m; i++) {
+                best = std::max(best, prices[i - 1] + B[width - i]);
+            }
+            for (int t = 0; t < width - 1; t++) {
+                B[t] = B[t + 1];
+            }
+            B[width - 1] = best;
+            x += 1;
+        }
+    }
+
+    // Ao final x == n e val[n] está no centro do bloco.
+    return B[m - 1];
+}
+
+/**
+ * @brief Corte de barras para comprimentos astronômicos (ex: n = 10^12).
+ *
+ * Primeiro tenta o atalho periódico com um orçamento de varredura de
+ * O(m log n) comprimentos (custo O(m² log n)); se o período não aparecer
+ * dentro desse orçamento, recorre à duplicação em (max,+).
+ * Memória O(m) nos dois casos, em vez do val(n + 1) de cutRod.
+ *
+ * @param prices Preços (mesmo formato de cutRod).
+ * @param n Comprimento da barra.
+ * @return long long O lucro máximo.
+ */
+long long cutRodLarge(const std::vector<int>& prices, long long n) {
+
+    int m = prices.size();
+    int bits = 1;
+    while ((n >> bits) > 0) {
+        bits++;
+    }
+
+    long long result;
+    long long scan_limit = (long long)m * (bits + 2) + 2LL * m;
+    if (cutRodPeriodic(prices, n, scan_limit, result)) {
+        return result;
+    }
+    return cutRodDoubling(prices, n);
+}
+
+/**
+ * @brief Parâmetros físicos da serra para o corte "realista".
+ */
+struct SawSettings {
+    int kerf;       // Material perdido em cada corte (largura da lâmina)
+    int cut_cost;   // Custo fixo cobrado por corte
+    int min_length; // Menor pedaço vendável; abaixo disso o material vira sobra
+};
+
+/**
+ * @brief Resultado do corte com serra: lucro líquido e o plano de cortes.
+ */
+struct CutPlan {
+    int revenue;             // Vendas menos o custo dos cortes
+    std::vector<int> pieces; // Comprimentos vendidos, na ordem em que são cortados
+    int cuts;                // Número de cortes feitos
+    int scrap;               // Sobra final não vendida (não inclui o kerf)
+};
+
+/**
+ * @brief Reconstrói o plano de cortes a partir da tabela de escolhas.
+ *
+ * choice[j] == 0 -> a barra j inteira vira sobra.
+ * choice[j] == j -> a barra j é vendida inteira (sem corte).
+ * caso contrário -> corta um pedaço choice[j], perde 'kerf' e segue com o resto
+ * (se sobrar menos que o kerf, a lâmina consome o resto e o plano termina).
+ *
+ * @param stride Distância entre choice[j] e choice[j+1] (1, ou o número de
+ * configurações no modo em lote).
+ */
+CutPlan buildCutPlan(const int* choice, int stride, int revenue, int n, int kerf) {
+    CutPlan plan = {revenue, {}, 0, 0};
+    int j = n;
+    while (j > 0) {
+        int i = choice[(long long)j * stride];
+        if (i == 0) {
+            plan.scrap = j;
+            break;
+        }
+        plan.pieces.push_back(i);
+        if (i == j) {
+            break;
+        }
+        plan.cuts++;
+        j = std::max(0, j - i - kerf);
+    }
+    return plan;
+}
+
+/**
+ * @brief Corte de barras com custo por corte, perda de kerf e comprimento mínimo vendável.
+ *
+ * Mesma tabela bottom-up de cutRod (O(n·m)), com a recorrência:
+ * g[j] = max( 0                                   (tudo vira sobra),
+ *             p_j                                 (vende inteira, se vendável),
+ *             p_i - cut_cost + g[max(0, j - i - kerf)] )  (corta um pedaço i < j)
+ * onde só são vendáveis pedaços com min_length <= i <= m. Se depois do pedaço
+ * sobra menos que o kerf, a lâmina consome essa ponta (g[0] = 0).
+ * Com kerf = 0, cut_cost = 0, min_length = 1 e preços não-negativos, g[n] == cutRod(prices, n).
+ *
+ * @param prices Preços (mesmo formato de cutRod).
+ * @param n Comprimento da barra original.
+ * @param saw Parâmetros da serra.
+ * @return CutPlan O lucro líquido e a sequência de pedaços.
+ */
+CutPlan cutRodWithSaw(const std::vector<int>& prices, int n, const SawSettings& saw) {
+
+    int m = prices.size();
+    std::vector<int> g(n + 1);
+    std::vector<int> choice(n + 1);
+    int first = std::max(saw.min_length, 1);
+
+    g[0] = 0;
+    choice[0] = 0;
+    for (int j = 1; j <= n; j++) {
+
+        // Opção base: não vender nada (a barra toda vira sobra).
+        int best = 0;
+        int best_i = 0;
+
+        // Vender a barra inteira, sem corte.
+        if (j >= first && j <= m && prices[j - 1] > best) {
+            best = prices[j - 1];
+            best_i = j;
+        }
+
+        // Cortar um primeiro pedaço vendável 'i' e continuar com o resto.
+        int last = std::min(m, j - 1);
+        for (int i = first; i <= last; i++) {
+            int value = prices[i - 1] - saw.cut_cost + g[std::max(0, j - i - saw.kerf)];
+            if (value > best) {
+                best = value;
+                best_i = i;
+            }
+        }
+        g[j] = best;
+        choice[j] = best_i;
+    }
+
+    return buildCutPlan(choice.data(), 1, g[n], n, saw.kerf);
+}
+
+/**
+ * @brief Avalia várias configurações de serra numa única passada sobre os preços.
+ *
+ * As tabelas g e choice ficam intercaladas (g[j * S + s]), de modo que para
+ * cada comprimento j e cada pedaço i o preço p_i é lido uma vez e reaproveitado
+ * por todas as S configurações.
+ *
+ * @param prices Preços (mesmo formato de cutRod).
+ * @param n Comprimento da barra original.
+ * @param settings Lista de configurações de serra.
+ * @return std::vector<CutPlan> Um plano por configuração, na mesma ordem.
+ */
+std::vector<CutPlan> cutRodWithSawBatch(const std::vector<int>& prices, int n,
+                                        const std::vector<SawSettings>& settings) {
+
+    int m = prices.size();
+    int S = settings.size();
+    std::vector<int> g((long long)(n + 1) * S, 0);
+    std::vector<int> choice((long long)(n + 1) * S, 0);
+
+    for (int j = 1; j <= n; j++) {
+        int* gj = &g[(long long)j * S];
+        int* cj = &choice[(long long)j * S];
+
+        // Inicializa cada configuração com "sobra" ou "vende inteira".
+        for (int s = 0; s < S; s++) {
+            gj[s] = 0;
+            cj[s] = 0;
+            if (j >= std::max(settings[s].min_length, 1) && j <= m && prices[j - 1] > 0) {
+                gj[s] = prices[j - 1];
+                cj[s] = j;
+            }
+        }
+
+        // Um pedaço 'i' por vez, aplicado a todas as configurações.
+        int last = std::min(m, j - 1);
+        for (int i = 1; i <= last; i++) {
+            int price = prices[i - 1];
+            for (int s = 0; s < S; s++) {
+                const SawSettings& saw = settings[s];
+                if (i < saw.min_length) {
+                    continue;
+                }
+                int value = price - saw.cut_cost + g[(long long)std::max(0, j - i - saw.kerf) * S + s];
+                if (value > gj[s]) {
+                    gj[s] = value;
+                    cj[s] = i;
+                }
+            }
+        }
+    }
+
+    std::vector<CutPlan> plans;
+    plans.reserve(S);
+    for (int s = 0; s < S; s++) {
+        plans.push_back(buildCutPlan(choice.data() + s, S, g[(long long)n * S + s], n, settings[s].kerf));
+    }
+    return plans;
+}
+
+/**
+ * @brief Estado do cutRod incremental: os preços atuais e a tabela val completa.
+ */
+struct CutRodState {
+    std::vector<int> prices; // Preços atuais (mesmo formato de cutRod)
+    std::vector<int> val;    // val[j] = lucro máximo para comprimento j (0 <= j <= n)
+    long long full_cells;    // Na última atualização: células recalculadas em O(m)
+    long long checked_cells; // Na última atualização: células conferidas em O(1)
+};
+
+/**
+ * @brief Recalcula uma célula de val com a recorrência do cutRod (O(m)).
+ */
+int cutRodCell(const std::vector<int>& prices, const std::vector<int>& val, int j) {
+    int m = prices.size();
+    int max_val = INT_MIN;
+    for (int i = 1; i <= std::min(j, m); i++) {
+        max_val = std::max(max_val, prices[i - 1] + val[j - i]);
+    }
+    return (max_val == INT_MIN) ? 0 : max_val;
+}
+
+/**
+ * @brief Monta o estado inicial do cutRod incremental (mesmo custo do cutRod).
+ */
+CutRodState cutRodBuild(const std::vector<int>& prices, int n) {
+    CutRodState state = {prices, std::vector<int>(n + 1, 0), 0, 0};
+    for (int j = 1; j <= n; j++) {
+        state.val[j] = cutRodCell(prices, state.val, j);
+    }
+    state.full_cells = n;
+    return state;
+}
+
+/**
+ * @brief Aplica várias mudanças de preço numa única passada sobre val.
+ *
+ * Só o sufixo j >= L (L = menor comprimento alterado) pode mudar. Enquanto
+ * houver mudanças recentes, cada célula é recalculada inteira (O(m)). Depois
+ * de m células seguidas sem mudança, a janela val[j-m..j-1] está igual à
+ * antiga e os únicos termos novos da recorrência são os dos preços
+ * alterados; então basta, para cada preço alterado p_L:
+ * - se subiu: comparar p_L' + val[j-L] com val[j];
+ * - se caiu: só importa se era ele quem dava o máximo
+ *   (val[j] == p_L + val[j-L]); nesse caso recalcula a célula.
+ * Cada célula custa O(k) para k preços alterados, em vez de O(m). Com muitos
+ * preços alterados (k > m/4) a conferência não compensa e tudo é recalculado.
+ *
+ * @param state Estado do cutRod incremental (atualizado no lugar).
+ * @param updates Pares (comprimento, novo preço), com 1 <= comprimento <= m.
+ * @return int O novo lucro máximo para a barra de comprimento n.
+ * @throws std::invalid_argument Se algum comprimento está fora de 1..m (o
+ * estado não é alterado).
+ */
+int cutRodUpdatePrices(CutRodState& state, const std::vector<std::pair<int, int>>& updates) {
+
+    int m = state.prices.size();
+    int n = state.val.size() - 1;
+    for (const auto& update : updates) {
+        if (update.first < 1 || update.first > m) {
+            throw std::invalid_argument("comprimento " + std::to_string(update.first) + " fora de 1.." + std::to_string(m));
+        }
+    }
+    state.full_cells = 0;
+    state.checked_cells = 0;
+
+    // --- Passo 1: Aplica os preços e guarda (comprimento, antigo, novo) ---
+    // Um comprimento repetido fica com o primeiro preço antigo e o último novo.
+    std::vector<int> old_prices = state.prices;
+    for (const auto& [length, price] : updates) {
+        state.prices[length - 1] = price;
+    }
+    std::vector<int> changed;
+    for (int L = 1; L <= m; L++) {
+        if (state.prices[L - 1] != old_prices[L - 1]) changed.push_back(L);
+    }
+    if (changed.empty() || changed[0] > n) {
+        return state.val[n];
+    }
+
+    // --- Passo 2: Varre o sufixo a partir do menor comprimento alterado ---
+    bool check_only = 4 * (int)changed.size() <= m;
+    int stable = 0; // Células seguidas sem mudança
+    for (int j = changed[0]; j <= n; j++) {
+        int value;
+        if (stable >= m && check_only) {
+            state.checked_cells++;
+            value = state.val[j];
+            bool lost_argmax = false;
+            for (int L : changed) {
+                if (L > j) break;
+                int now = state.prices[L - 1], before = old_prices[L - 1];
+                if (now > before) {
+                    value = std::max(value, now + state.val[j - L]);
+                } else if (state.val[j] == before + state.val[j - L]) {
+                    lost_argmax = true;
+                }
+            }
+            if (lost_argmax) {
+                state.full_cells++;
+                value = cutRodCell(state.prices, state.val, j);
+            }
+        } else {
+            state.full_cells++;
+            value = cutRodCell(state.prices, state.val, j);
+        }
+
+        if (value == state.val[j]) {
+            stable++;
+        } else {
+            stable = 0;
+            state.val[j] = value;
+        }
+    }
+    return state.val[n];
+}
+
+/**
+ * @brief Muda o preço de um único comprimento (caso comum do feed de preços).
+ *
+ * @throws std::invalid_argument Se length está fora de 1..m.
+ */
+int cutRodUpdatePrice(CutRodState& state, int length, int price) {
+    return cutRodUpdatePrices(state, {{length, price}});
+}
+
+/**
+ * @brief Forma da curva de preços, detectada pelas segundas diferenças.
+ */
+enum PriceShape {
+    PRICES_GENERAL, // Nenhuma estrutura: usa o cutRod comum
+    PRICES_CONCAVE, // p_{i+1} - p_i não cresce
+    PRICES_CONVEX   // p_{i+1} - p_i não decresce
+};
+
+/**
+ * @brief Classifica a curva de preços em O(m). Curvas lineares contam como côncavas.
+ */
+PriceShape classifyPrices(const std::vector<int>& prices) {
+    bool concave = true, convex = true;
+    for (size_t i = 2; i < prices.size(); i++) {
+        long long second = (long long)prices[i] - 2LL * prices[i - 1] + prices[i - 2];
+        if (second > 0) concave = false;
+        if (second < 0) convex = false;
+    }
+    if (concave) return PRICES_CONCAVE;
+    if (convex) return PRICES_CONVEX;
+    return PRICES_GENERAL;
+}
+
+/**
+ * @brief cutRod com caminho rápido para preços côncavos ou convexos.
+ *
+ * Em vez de um kernel SMAWK sobre a tabela val inteira, usamos o argumento
+ * de troca, que dá a estrutura da solução ótima diretamente:
+ * - Côncava: mover uma unidade de um pedaço maior para um menor nunca piora,
+ *   então para k pedaços o ótimo é equilibrado (r pedaços de q+1 e k-r de q,
+ *   com n = k·q + r). Basta varrer k >= ceil(n/m): O(n).
+ * - Convexa: mover uma unidade de um pedaço menor para um maior nunca piora,
+ *   então no ótimo há c pedaços de m, no máximo um pedaço "do meio" x e o
+ *   resto de tamanho 1. Para cada c, o melhor x vem de um máximo de prefixo
+ *   de p_x - x·p_1: O(m + n/m).
+ * Sem nenhuma das duas formas, cai no cutRod comum (O(n·m)).
+ *
+ * @param prices Preços (mesmo formato de cutRod).
+ * @param n Comprimento total da barra.
+ * @return int O lucro máximo (igual a cutRod(prices, n)).
+ */
+int cutRodStructured(const std::vector<int>& prices, int n) {
+
+    int m = prices.size();
+    if (n <= 0 || m == 0) return 0;
+    auto p = [&](int length) { return (long long)prices[length - 1]; };
+
+    PriceShape shape = classifyPrices(prices);
+    if (shape == PRICES_CONCAVE) {
+        // --- Pedaços equilibrados: k pedaços, r deles com um a mais ---
+        long long best = LLONG_MIN;
+        for (int k = (n + m - 1) / m; k <= n; k++) {
+            int q = n / k, r = n % k;
+            long long value = (long long)(k - r) * p(q) + (r > 0 ? r * p(q + 1) : 0);
+            best = std::max(best, value);
+        }
+        return (int)best;
+    }
+
+    if (shape == PRICES_CONVEX) {
+        // --- c pedaços de m, um pedaço x (opcional) e o resto de tamanho 1 ---
+        // prefix_best[t] = max_{1 <= x <= t} p_x - x·p_1 (0 = nenhum pedaço do meio).
+        std::vector<long long> prefix_best(m + 1, 0);
+        for (int x = 1; x <= m; x++) {
+            prefix_best[x] = std::max(prefix_best[x - 1], p(x) - x * p(1));
+        }
+        long long best = LLONG_MIN;
+        for (int c = 0; (long long)c * m <= n; c++) {
+            int rest = n - c * m;
+            long long value = c * p(m) + rest * p(1) + prefix_best[std::min(m, rest)];
+            best = std::max(best, value);
+        }
+        return (int)best;
+    }
+
+    return cutRod(prices, n);
+}
+
+// Cenários processados juntos por cutRodBatch (uma lane de vetor cada).
+const int BATCH_LANES = 16;
+
+/**
+ * @brief cutRod para muitos cenários de preço de uma vez (structure-of-arrays).
+ *
+ * Os cenários são agrupados em blocos de BATCH_LANES. Dentro de um bloco os
+ * preços e a tabela val ficam intercalados (val[j * BATCH_LANES + s]), então
+ * o passo val[j] = max_i p_i + val[j - i] vira um laço de tamanho fixo sobre
+ * as lanes, que o compilador vetoriza (8 ints por AVX2, 16 por AVX-512).
+ * Blocos são distribuídos entre threads; cada thread reaproveita sua tabela
+ * entre blocos, em vez de alocar um val por cenário.
+ *
+ * Cenários podem ter tamanhos de tabela diferentes: as posições que faltam
+ * recebem um preço muito negativo e nunca são escolhidas.
+ *
+ * @param scenarios scenarios[s] = vetor de preços do cenário s (formato de cutRod).
+ * @param n Comprimento total da barra (o mesmo para todos).
+ * @param threads Número de threads (0 = hardware_concurrency).
+ * @return std::vector<int> Buffer contíguo com result[s] = cutRod(scenarios[s], n).
+ */
+std::vector<int> cutRodBatch(const std::vector<std::vector<int>>& scenarios, int n, int threads = 0) {
+
+    int S = scenarios.size();
+    std::vector<int> result(S, 0);
+    if (S == 0 || n <= 0) return result;
+
+    int m = 0;
+    for (const std::vector<int>& prices : scenarios) {
+        m = std::max(m, (int)prices.size());
+    }
+    const int NEG = INT_MIN / 4; // "Sem preço": perde para qualquer corte válido
+    int blocks = (S + BATCH_LANES - 1) / BATCH_LANES;
+    std::atomic<int> next_block(0);
+
+    auto worker = [&]() {
+        std::vector<int> P((size_t)m * BATCH_LANES);
+        std::vector<int> val((size_t)(n + 1) * BATCH_LANES);
+        for (int block = next_block++; block < blocks; block = next_block++) {
+            int first = block * BATCH_LANES;
+
+            // --- Passo 1: Preços intercalados (lanes sem cenário ficam com NEG) ---
+            for (int i = 0; i < m; i++) {
+                for (int s = 0; s < BATCH_LANES; s++) {
+                    int scenario = first + s;
+                    bool has = scenario < S && i < (int)scenarios[scenario].size();
+                    P[(size_t)i * BATCH_LANES + s] = has ? scenarios[scenario][i] : NEG;
+                }
+            }
+
+            // --- Passo 2: A mesma recorrência do cutRod, uma lane por cenário ---
+            std::fill(val.begin(), val.begin() + BATCH_LANES, 0);
+            for (int j = 1; j <= n; j++) {
+                int best[BATCH_LANES];
+                for (int s = 0; s < BATCH_LANES; s++) best[s] = NEG;
+                int last = std::min(j, m);
+                for (int i = 1; i <= last; i++) {
+                    const int* price = &P[(size_t)(i - 1) * BATCH_LANES];
+                    const int* rest = &val[(size_t)(j - i) * BATCH_LANES];
+                    for (int s = 0; s < BATCH_LANES; s++) {
+                        best[s] = std::max(best[s], price[s] + rest[s]);
+                    }
+                }
+                // Nenhum corte possível (cenário sem preços): lucro 0, como no cutRod.
+                int* out = &val[(size_t)j * BATCH_LANES];
+                for (int s = 0; s < BATCH_LANES; s++) {
+                    out[s] = best[s] < NEG / 2 ? 0 : best[s];
+                }
+            }
+
+            for (int s = 0; s < BATCH_LANES && first + s < S; s++) {
+                result[first + s] = val[(size_t)n * BATCH_LANES + s];
+            }
+        }
+    };
+
+    if (threads <= 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = std::min(threads, blocks);
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; t++) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& th : pool) th.join();
+    return result;
+}
+
 // Main para teste
 int main() {
     // Este é o exemplo clássico do livro do Cormen
@@ -109,5 +759,170 @@ int main() {
     std::cout << "(Corte em pedacos de 3 (8) e 10 (30))" << std::endl;
     std::cout << "---" << std::endl;
 
+    // --- Teste 4 ---
+    // Barras astronômicas: periodicidade e duplicação em (max,+), memória O(m).
+    // Primeiro conferimos os dois métodos contra cutRod para n pequenos.
+    std::cout << "--- Teste 4: Barras muito longas (n ate 10^12) ---" << std::endl;
+    std::vector<int> prices_irregular = {3, 5, 9, 10, 16, 17, 23, 26};
+    bool all_ok = true;
+    for (int n = 0; n <= 300; n++) {
+        long long periodic;
+        cutRodPeriodic(prices, n, n, periodic);
+        all_ok = all_ok && periodic == cutRod(prices, n)
+                        && cutRodDoubling(prices, n) == cutRod(prices, n)
+                        && cutRodLarge(prices_irregular, n) == cutRod(prices_irregular, n)
+                        && cutRodDoubling(prices_irregular, n) == cutRod(prices_irregular, n);
+    }
+    std::cout << "Periodicidade/duplicacao == cutRod para n em [0, 300]: "
+              << (all_ok ? "OK" : "FALHOU") << std::endl;
+
+    long long n4 = 1000000000000LL;
+    std::cout << "Comprimento da barra: " << n4 << std::endl;
+    std::cout << "Lucro maximo (auto):       " << cutRodLarge(prices, n4) << std::endl; // Esperado: 3000000000000
+    std::cout << "Lucro maximo (duplicacao): " << cutRodDoubling(prices, n4) << std::endl;
+    std::cout << "(Pedacos de 10, densidade 3 por unidade)" << std::endl;
+    std::cout << "---" << std::endl;
+
+    // --- Teste 5 ---
+    // Serra real: cada corte custa 2, perde 1 de material, e pedaços < 2 não vendem.
+    std::cout << "--- Teste 5: Corte com kerf, custo por corte e sobra minima ---" << std::endl;
+    int n5 = 13;
+    SawSettings saw = {1, 2, 2};
+    CutPlan plan = cutRodWithSaw(prices, n5, saw);
+    std::cout << "Comprimento da barra: " << n5 << " (kerf 1, custo 2 por corte, minimo 2)" << std::endl;
+    std::cout << "Lucro liquido: " << plan.revenue << std::endl; // Esperado: 33
+    std::cout << "Pedacos:";
+    for (int piece : plan.pieces) std::cout << " " << piece;
+    std::cout << " | cortes: " << plan.cuts << " | sobra: " << plan.scrap << std::endl;
+    // Esperado: pedaços 2 e 10 (5 + 30 - 2 de corte, 1 de kerf)
+
+    // Ponta menor que o kerf: cortar 10 de uma barra de 11 com kerf 2 é válido,
+    // a lâmina consome o último 1 de material.
+    CutPlan tail = cutRodWithSaw(prices, 11, {2, 0, 1});
+    std::cout << "Barra 11, kerf 2: lucro " << tail.revenue << ", pedacos:"; // Esperado: 30
+    for (int piece : tail.pieces) std::cout << " " << piece;
+    std::cout << " | cortes: " << tail.cuts << " | sobra: " << tail.scrap << std::endl;
+
+    // Sem kerf, sem custo e mínimo 1 o resultado tem que coincidir com cutRod.
+    // O modo em lote tem que coincidir com as chamadas individuais.
+    std::vector<SawSettings> settings = {{0, 0, 1}, {1, 2, 2}, {2, 0, 3}, {0, 5, 1}};
+    std::vector<CutPlan> batch = cutRodWithSawBatch(prices, n5, settings);
+    bool batch_ok = batch[0].revenue == cutRod(prices, n5);
+    for (size_t s = 0; s < settings.size(); s++) {
+        CutPlan single = cutRodWithSaw(prices, n5, settings[s]);
+        batch_ok = batch_ok && single.revenue == batch[s].revenue && single.pieces == batch[s].pieces;
+    }
+    std::cout << "Lote com " << settings.size() << " configuracoes == chamadas individuais: "
+              << (batch_ok ? "OK" : "FALHOU") << std::endl;
+    std::cout << "---" << std::endl;
+
+    // --- Teste 6 ---
+    // Preços mudando um a um (e em lotes): o estado incremental tem que
+    // coincidir com um cutRod completo depois de cada atualização.
+    std::cout << "--- Teste 6: Atualizacao incremental de precos ---" << std::endl;
+    CutRodState state = cutRodBuild(prices, 100);
+    std::cout << "Lucro inicial (n = 100): " << state.val[100] << std::endl; // Esperado: 300
+    std::cout << "Preco do tamanho 4 sobe para 14: " << cutRodUpdatePrice(state, 4, 14) << std::endl; // Esperado: 350
+    std::cout << "Celulas recalculadas: " << state.full_cells
+              << " | conferidas em O(1): " << state.checked_cells << std::endl;
+    std::cout << "Preco do tamanho 7 sobe para 18: " << cutRodUpdatePrice(state, 7, 18) << std::endl; // Esperado: 350
+    std::cout << "Celulas recalculadas: " << state.full_cells
+              << " | conferidas em O(1): " << state.checked_cells << std::endl;
+
+    bool incremental_ok = true;
+    unsigned seed = 12345;
+    auto next = [&seed]() { seed = seed * 1103515245u + 12345u; return (seed >> 16) & 0x7fff; };
+    std::vector<int> feed = prices_irregular;
+    CutRodState feed_state = cutRodBuild(feed, 500);
+    for (int step = 0; step < 300; step++) {
+        std::vector<std::pair<int, int>> updates;
+        int count = step % 3 == 0 ? 1 + next() % 4 : 1;
+        for (int u = 0; u < count; u++) {
+            int length = 1 + next() % feed.size();
+            int price = feed[length - 1] + (int)(next() % 7) - 3;
+            updates.push_back({length, price});
+            feed[length - 1] = price;
+        }
+        int result = cutRodUpdatePrices(feed_state, updates);
+        incremental_ok = incremental_ok && result == cutRod(feed, 500) && feed_state.prices == feed;
+    }
+    std::cout << "300 lotes de atualizacoes == cutRod completo: "
+              << (incremental_ok ? "OK" : "FALHOU") << std::endl;
+
+    // Comprimento fora da tabela de preços: rejeitado antes de mexer no estado.
+    try {
+        cutRodUpdatePrice(feed_state, (int)feed.size() + 1, 99);
+        std::cout << "Erro: comprimento fora da tabela deveria ser rejeitado" << std::endl;
+    } catch (const std::invalid_argument& error) {
+        std::cout << "Rejeitado: " << error.what() << ", estado intacto: "
+                  << (feed_state.prices == feed && feed_state.val[500] == cutRod(feed, 500) ? "OK" : "FALHOU") << std::endl;
+    }
+    std::cout << "---" << std::endl;
+
+    // --- Teste 7 ---
+    // Curvas côncavas/convexas usam o caminho rápido; as outras caem no cutRod.
+    std::cout << "--- Teste 7: Caminho rapido para precos concavos/convexos ---" << std::endl;
+    const char* shape_names[] = {"geral", "concava", "convexa"};
+    std::cout << "Precos do Cormen: " << shape_names[classifyPrices(prices)] << std::endl;
+    bool structured_ok = true;
+    for (int trial = 0; trial < 200; trial++) {
+        // Diferenças aleatórias ordenadas geram curvas côncavas (decrescentes) ou convexas (crescentes).
+        int m = 1 + next() % 20;
+        std::vector<int> diffs(m);
+        for (int& d : diffs) d = (int)(next() % 40) - 10;
+        std::sort(diffs.begin(), diffs.end());
+        if (trial % 2 == 0) std::reverse(diffs.begin(), diffs.end());
+        std::vector<int> curve(m);
+        int acc = 0;
+        for (int i = 0; i < m; i++) curve[i] = acc += diffs[i];
+        for (int n = 0; n <= 120; n += 7) {
+            structured_ok = structured_ok && cutRodStructured(curve, n) == cutRod(curve, n);
+        }
+        structured_ok = structured_ok && classifyPrices(curve) != PRICES_GENERAL;
+    }
+    structured_ok = structured_ok && cutRodStructured(prices_irregular, 77) == cutRod(prices_irregular, 77);
+    std::cout << "Curvas aleatorias concavas/convexas == cutRod: " << (structured_ok ? "OK" : "FALHOU") << std::endl;
+
+    // Curva côncava com m = 2000: o cutRod faz n·m passos, o caminho rápido n.
+    std::vector<int> concave_prices(2000);
+    for (int i = 1; i <= 2000; i++) concave_prices[i - 1] = 5000 * i - i * i;
+    int n7 = 20000;
+    auto t0 = std::chrono::steady_clock::now();
+    int fast = cutRodStructured(concave_prices, n7);
+    auto t1 = std::chrono::steady_clock::now();
+    int slow = cutRod(concave_prices, n7);
+    auto t2 = std::chrono::steady_clock::now();
+    std::cout << "n = " << n7 << ", m = 2000 (" << shape_names[classifyPrices(concave_prices)] << "): "
+              << fast << " vs " << slow << " | rapido "
+              << std::chrono::duration<double, std::milli>(t1 - t0).count() << " ms, cutRod "
+              << std::chrono::duration<double, std::milli>(t2 - t1).count() << " ms" << std::endl;
+    std::cout << "---" << std::endl;
+
+    // --- Teste 8 ---
+    // Milhares de cenários de preço para a mesma barra: lote vs um cutRod por cenário.
+    std::cout << "--- Teste 8: Lote de cenarios de preco (SoA) ---" << std::endl;
+    int S8 = 4000, n8 = 300;
+    std::vector<std::vector<int>> scenarios(S8);
+    for (int sc = 0; sc < S8; sc++) {
+        scenarios[sc] = prices;
+        for (int& price : scenarios[sc]) price += (int)(next() % 9) - 4;
+        scenarios[sc].resize(1 + sc % prices.size()); // Tamanhos diferentes
+    }
+    scenarios[7].clear(); // Cenário sem preços: lucro 0
+    auto b0 = std::chrono::steady_clock::now();
+    std::vector<int> batch_results = cutRodBatch(scenarios, n8);
+    auto b1 = std::chrono::steady_clock::now();
+    bool lanes_ok = true;
+    for (int sc = 0; sc < S8; sc++) {
+        lanes_ok = lanes_ok && batch_results[sc] == cutRod(scenarios[sc], n8);
+    }
+    auto b2 = std::chrono::steady_clock::now();
+    std::cout << S8 << " cenarios, n = " << n8 << ": lote == cutRod por cenario: "
+              << (lanes_ok ? "OK" : "FALHOU") << std::endl;
+    std::cout << "Tempo: lote " << std::chrono::duration<double, std::milli>(b1 - b0).count()
+              << " ms, um por um " << std::chrono::duration<double, std::milli>(b2 - b1).count()
+              << " ms" << std::endl;
+    std::cout << "---" << std::endl;
+
     return 0;
 }
\ No newline at end of file